@@ -3,12 +3,28 @@
 #include <string>
 #include <algorithm>
 #include <array>
-#include <functional>
 #include <chrono>
-#include <unordered_set>
 #include <thread>
 #include <mutex>
+#include <cstdint>
+#include <iomanip>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <cstring>
+#if defined(__unix__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#include "SudokuSolver.h"
 using namespace std;
+using namespace sudoku;
 
 //--------------------------------------------------------------------
 // This program solves the Jane Street "Somewhat Square Sudoku" puzzle (January 2025)
@@ -22,490 +38,878 @@ using namespace std;
 // The answer to the puzzle is the 9-digit number formed by the middle row in the completed grid.
 //--------------------------------------------------------------------
 
+// Per-configuration wins over a run, for tuning the portfolio.
+struct PortfolioTally {
+    unsigned long long wins = 0;
+    double seconds = 0;
+};
+
 //--------------------------------------------------------------------
-// Helper functions (from your code)
+// Command-line options
 //--------------------------------------------------------------------
+struct SolverOptions {
+    EngineConfig config;        // kernels, engine and search settings passed to the library
+    string portfolioLog;        // CSV file that portfolio wins are appended to
+    string puzzleFile;          // puzzle definition to solve instead of the built-in one
+    string savePuzzle;          // file the puzzle definition is written to
+    string incrementalState;    // sweep state reused and updated across runs
+    string cacheDir;            // directory of cached results, keyed by puzzle hash
+    string emitTables;          // SudokuTables.inc to write for an embedded-tables build
+    size_t selfCheck = 0;       // differential self-check iterations to run instead of solving
+    bool workerStats = false;   // report per-worker scheduling counters
+    string traceFile;           // Chrome trace-event JSON of every worker task
+    bool histograms = false;    // print per-GCD stage cost percentiles at the end
+    size_t histogramEvery = 0;  // and every this many examined GCDs (0: only at the end)
+    unsigned threads = 0;       // generation threads; 0 leaves one core free
+    int benchScaling = 0;       // largest thread count of the scaling benchmark to run instead of solving
+    string synthesize;          // directory to write a synthetic puzzle corpus to instead of solving
+    int synthCount = 3;         // puzzles per difficulty tier
+    uint32_t synthGCD = 12345679;   // GCD the planted solutions' rows are multiples of
+    double synthGivens = -1;    // custom tier: share of cells given (negative: easy/medium/hard tiers)
+    double synthDisallowed = 0; // custom tier: share of cells with digits ruled out
+    string metrics;             // OpenMetrics endpoint: a localhost TCP port or unix:PATH
+    string profileFile;         // folded-stack CPU profile written at exit
+    unsigned profileHz = 499;   // profiler samples per CPU-second
+    int maxGCD = 12345678;      // first candidate GCD tested
+    int minGCD = 337;           // last candidate GCD tested
+};
 
-// 1) Check if a number (9-char string) contains specific required digits
-bool containsRequiredDigits(const string& number, const vector<char>& requiredDigits) {
-    // Use a bit mask for faster checking
-    int digitMask = 0;
-    for (char c : number) {
-        digitMask |= (1 << (c - '0'));
-    }
-    
-    for (char digit : requiredDigits) {
-        if ((digitMask & (1 << (digit - '0'))) == 0) {
-            return false; // Missing a required digit
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]\n"
+         << "  --kernels=NAME       Kernel set: auto (default), scalar, avx2 or avx512\n"
+         << "  --value-order=ORDER  Candidate order within a row: lcv (default) or generation\n"
+         << "  --first-solution     Stop at the first solution instead of enumerating all of them\n"
+         << "  --restarts[=UNIT]    Randomized first-solution search with Luby restarts of UNIT\n"
+         << "                       candidate tries (default 100000)\n"
+         << "  --restart-workers=N  Race N randomized searches per GCD, stopping on the first witness\n"
+         << "  --seed=N             Seed for randomized searches (default 1)\n"
+         << "  --engine=NAME        Per-GCD engine: backtrack (default), sat (built-in CDCL solver), clique\n"
+         << "                       (bit-parallel clique search over compatible row candidates) or digits\n"
+         << "                       (one digit at a time, tracking each row's residue modulo the GCD)\n"
+         << "  --dimacs-dir=DIR     Write each searched instance's CNF to DIR/gcd<N>-without<M>.cnf\n"
+         << "  --portfolio          Race several solver configurations per GCD; the first answer wins\n"
+         << "  --portfolio-log=FILE Append each GCD's winning configuration to FILE (CSV)\n"
+         << "  --puzzle=FILE        Solve the puzzle definition in FILE instead of the January 2025 one\n"
+         << "  --save-puzzle=FILE   Write the puzzle definition to FILE (a starting point for variants)\n"
+         << "  --incremental=FILE   Keep per-GCD results in FILE and reuse those a puzzle edit can't change\n"
+         << "  --cache-dir=DIR      Answer from, resume from and update the result cache in DIR\n"
+         << "  --emit-tables=FILE   Write the puzzle's row tables to FILE for -DSUDOKU_EMBEDDED_TABLES and exit\n"
+         << "  --no-symmetry-breaking  Search interchangeable rows' symmetric grids separately\n"
+         << "  --self-check[=N]     Fuzz the optimized kernels and solvers against the reference\n"
+         << "                       implementations for N iterations (default 200), then exit\n"
+         << "  --deterministic      Parallel searches return the same result and counters on every run\n"
+         << "  --numa-replicate     Give each NUMA node its own copy of the instance and pin the parallel\n"
+         << "                       workers to their node's copy\n"
+         << "  --worker-stats       Show per-worker busy/idle time, tasks, steals and queue depth of the\n"
+         << "                       parallel stages in progress updates and at the end\n"
+         << "  --trace=FILE         Write every worker task as Chrome trace-event JSON to FILE\n"
+         << "  --histograms         Print percentiles of the per-GCD filter, conversion and solver times\n"
+         << "                       and nodes explored at the end of the run\n"
+         << "  --histogram-every=N  Also print them after every N examined GCDs\n"
+         << "  --threads=N          Threads for permutation generation (default: all cores but one)\n"
+         << "  --bench-scaling[=N]  Time generation, filtering and backtracking at 1, 2, 4, ... N threads\n"
+         << "                       (default: all cores) on fixed inputs, print scaling tables and exit\n"
+         << "  --synthesize=DIR     Write a corpus of generated puzzles with planted solutions to DIR and exit\n"
+         << "  --synth-count=N      Puzzles per difficulty tier (default 3)\n"
+         << "  --synth-gcd=N        Planted solutions' rows are multiples of N (default 12345679)\n"
+         << "  --synth-density=G,D  One custom tier with G of the cells given and D with digits ruled out\n"
+         << "                       (shares, e.g. 0.1,0.2) instead of the easy/medium/hard tiers\n"
+         << "  --metrics=PORT       Serve OpenMetrics text on http://127.0.0.1:PORT/metrics during the run\n"
+         << "  --metrics=unix:PATH  The same on a Unix socket\n"
+         << "  --profile=FILE       Sample CPU time by phase and search depth; write folded stacks to FILE\n"
+         << "  --profile-hz=N       Profiler samples per CPU-second (default 499)\n"
+         << "  --max-gcd=N          Largest candidate GCD to test (default 12345678)\n"
+         << "  --min-gcd=N          Smallest candidate GCD to test (default 337)\n"
+         << "  --help               Show this message\n";
+}
+
+bool parseOptions(int argc, char* argv[], SolverOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg.rfind("--kernels=", 0) == 0) {
+                options.config.kernels = arg.substr(10);
+            } else if (arg == "--value-order=lcv" || arg == "--value-order=generation") {
+                options.config.valueOrder = arg.substr(14);
+            } else if (arg == "--first-solution") {
+                options.config.firstSolution = true;
+            } else if (arg == "--restarts") {
+                options.config.restartUnit = 100000;
+            } else if (arg.rfind("--restarts=", 0) == 0) {
+                options.config.restartUnit = max(1ULL, stoull(arg.substr(11)));
+            } else if (arg.rfind("--restart-workers=", 0) == 0) {
+                options.config.restartWorkers = max(1, stoi(arg.substr(18)));
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                options.config.seed = stoull(arg.substr(7));
+            } else if (arg == "--engine=backtrack" || arg == "--engine=sat" || arg == "--engine=clique" || arg == "--engine=digits") {
+                options.config.engine = arg.substr(9);
+            } else if (arg.rfind("--dimacs-dir=", 0) == 0) {
+                options.config.dimacsDir = arg.substr(13);
+            } else if (arg == "--portfolio") {
+                options.config.portfolio = true;
+            } else if (arg.rfind("--portfolio-log=", 0) == 0) {
+                options.portfolioLog = arg.substr(16);
+            } else if (arg.rfind("--puzzle=", 0) == 0) {
+                options.puzzleFile = arg.substr(9);
+            } else if (arg.rfind("--save-puzzle=", 0) == 0) {
+                options.savePuzzle = arg.substr(14);
+            } else if (arg.rfind("--incremental=", 0) == 0) {
+                options.incrementalState = arg.substr(14);
+            } else if (arg.rfind("--cache-dir=", 0) == 0) {
+                options.cacheDir = arg.substr(12);
+            } else if (arg.rfind("--emit-tables=", 0) == 0) {
+                options.emitTables = arg.substr(14);
+            } else if (arg == "--no-symmetry-breaking") {
+                options.config.symmetryBreaking = false;
+            } else if (arg == "--self-check") {
+                options.selfCheck = 200;
+            } else if (arg.rfind("--self-check=", 0) == 0) {
+                options.selfCheck = max(1ULL, stoull(arg.substr(13)));
+            } else if (arg == "--deterministic") {
+                options.config.deterministic = true;
+            } else if (arg == "--numa-replicate") {
+                options.config.numaReplicate = true;
+            } else if (arg == "--worker-stats") {
+                options.workerStats = true;
+            } else if (arg == "--histograms") {
+                options.histograms = true;
+            } else if (arg.rfind("--histogram-every=", 0) == 0) {
+                options.histogramEvery = max(1ULL, stoull(arg.substr(18)));
+                options.histograms = true;
+            } else if (arg.rfind("--trace=", 0) == 0) {
+                options.traceFile = arg.substr(8);
+                options.config.traceWorkers = true;
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                options.threads = unsigned(max(1, stoi(arg.substr(10))));
+            } else if (arg == "--bench-scaling") {
+                options.benchScaling = int(max(1u, thread::hardware_concurrency()));
+            } else if (arg.rfind("--bench-scaling=", 0) == 0) {
+                options.benchScaling = max(1, stoi(arg.substr(16)));
+            } else if (arg.rfind("--synthesize=", 0) == 0) {
+                options.synthesize = arg.substr(13);
+            } else if (arg.rfind("--synth-count=", 0) == 0) {
+                options.synthCount = max(1, stoi(arg.substr(14)));
+            } else if (arg.rfind("--synth-gcd=", 0) == 0) {
+                options.synthGCD = uint32_t(max(1UL, stoul(arg.substr(12))));
+            } else if (arg.rfind("--synth-density=", 0) == 0) {
+                string value = arg.substr(16);
+                size_t comma = value.find(',');
+                options.synthGivens = stod(value.substr(0, comma));
+                options.synthDisallowed = comma == string::npos ? 0 : stod(value.substr(comma + 1));
+            } else if (arg.rfind("--metrics=", 0) == 0) {
+                options.metrics = arg.substr(10);
+            } else if (arg.rfind("--profile=", 0) == 0) {
+                options.profileFile = arg.substr(10);
+            } else if (arg.rfind("--profile-hz=", 0) == 0) {
+                options.profileHz = unsigned(min(1000000, max(1, stoi(arg.substr(13)))));
+            } else if (arg.rfind("--max-gcd=", 0) == 0) {
+                options.maxGCD = stoi(arg.substr(10));
+            } else if (arg.rfind("--min-gcd=", 0) == 0) {
+                options.minGCD = stoi(arg.substr(10));
+            } else {
+                if (arg != "--help") {
+                    cerr << "Unknown option: " << arg << endl;
+                }
+                printUsage(argv[0]);
+                return false;
+            }
+        } catch (const exception&) {
+            cerr << "Invalid value in option: " << arg << endl;
+            printUsage(argv[0]);
+            return false;
         }
     }
     return true;
 }
 
-// 2) Given a list of candidate strings, filter and keep only those divisible by candidateGCD.
-vector<string> filterDivisibleByCandidate(const vector<string>& options, int candidateGCD) {
-    vector<string> filtered;
-    filtered.reserve(options.size() / 2); // Estimate capacity to avoid reallocations
-    
-    // Use a faster method for checking divisibility
-    // For large numbers, we can use modular arithmetic instead of full conversion
-    for (const string& opt : options) {
-        // For 9-digit numbers, we can use a more efficient approach
-        // than converting the entire string to a long long
+//--------------------------------------------------------------------
+// Console reporting
+//--------------------------------------------------------------------
+
+// One line per parallel stage: workers, tasks and the share of worker time spent busy.
+void printStageUtilization(const vector<WorkerTelemetry>& workers) {
+    map<string, WorkerTelemetry> stages;
+    map<string, int> workerCounts;
+    for (const WorkerTelemetry& worker : workers) {
+        WorkerTelemetry& stage = stages[worker.stage];
+        stage.tasks += worker.tasks;
+        stage.busySeconds += worker.busySeconds;
+        stage.idleSeconds += worker.idleSeconds;
+        workerCounts[worker.stage]++;
+    }
+    for (const auto& entry : stages) {
+        const WorkerTelemetry& stage = entry.second;
+        double total = stage.busySeconds + stage.idleSeconds;
+        cout << "  Workers (" << entry.first << "): " << workerCounts[entry.first] << ", " << stage.tasks
+             << " task(s), " << fixed << setprecision(1) << (total > 0 ? 100 * stage.busySeconds / total : 0.0)
+             << "% busy" << defaultfloat << endl;
+    }
+}
+
+// Per-worker table of the scheduling counters.
+void printWorkerTelemetry(const vector<WorkerTelemetry>& workers) {
+    cout << "\nWorker telemetry (stage, worker: tasks, busy s, idle s, steals/attempts, mean/max queue depth):" << endl;
+    for (const WorkerTelemetry& worker : workers) {
+        cout << "  " << worker.stage << " " << worker.worker << ": " << worker.tasks << ", " << fixed
+             << setprecision(3) << worker.busySeconds << ", " << worker.idleSeconds << ", " << worker.steals << "/"
+             << worker.stealAttempts << ", " << setprecision(1)
+             << (worker.queueSamples ? double(worker.queueDepthSum) / worker.queueSamples : 0.0) << "/"
+             << worker.queueDepthMax << defaultfloat << endl;
+    }
+}
+
+// Percentiles of each per-GCD stage cost; times in microseconds.
+void printStageHistograms(const StageHistograms& histograms) {
+    auto line = [](const char* name, const LatencyHistogram& h, double scale) {
+        cout << "  " << left << setfill(' ') << setw(16) << name << right << fixed << setprecision(scale < 1 ? 1 : 0)
+             << " p50 " << h.percentile(50) * scale << "  p90 " << h.percentile(90) * scale
+             << "  p99 " << h.percentile(99) * scale << "  p99.9 " << h.percentile(99.9) * scale
+             << "  max " << h.max() * scale << "  mean " << h.mean() * scale << defaultfloat << endl;
+    };
+    cout << "Per-GCD stage costs: " << histograms.filterNanos.count() << " GCD(s) filtered, "
+         << histograms.solverNanos.count() << " solved." << endl;
+    line("filter (us)", histograms.filterNanos, 1e-3);
+    if (histograms.solverNanos.count() > 0) {
+        line("conversion (us)", histograms.conversionNanos, 1e-3);
+        line("solver (us)", histograms.solverNanos, 1e-3);
+        line("nodes", histograms.nodes, 1);
+    }
+}
+
+// Strong- and weak-scaling tables of the benchmark, one row per stage and thread count.
+void printScalingTables(const vector<ScalingPoint>& points) {
+    for (bool weak : {false, true}) {
+        cout << (weak ? "\nWeak scaling (fixed work per thread; generation has no weak variant):"
+                      : "\nStrong scaling (fixed total work):") << endl;
+        cout << "  stage       threads   seconds  speedup  efficiency   GB/s (est.)" << endl;
+        for (const ScalingPoint& point : points) {
+            if (point.weak != weak) continue;
+            cout << "  " << left << setfill(' ') << setw(10) << point.stage << right << setw(9) << point.threads
+                 << fixed << setprecision(3) << setw(10) << point.seconds << setprecision(2) << setw(9)
+                 << point.speedup << setw(11) << 100 * point.efficiency << "%" << setw(14)
+                 << point.gigabytesPerSecond << defaultfloat << endl;
+        }
+    }
+}
+
+// Prints each GCD's search as it runs, with a progress line every 30 seconds.
+class ConsoleObserver : public SearchObserver {
+public:
+    ConsoleObserver(const SolverOptions& options, const Engine& engine, const PuzzleDefinition& puzzle,
+                    SweepState* state, const ResultCache* cache, CachedResult* cached)
+        : options(options), engine(engine), puzzle(puzzle), state(state), cache(cache), cached(cached) {}
+    
+    void solveStarted(uint32_t gcd, const SearchProgress& progress) override {
+        solverRunning = true;
+        cout << "Starting solver for GCD " << gcd << "..." << endl;
+        
+        // Set up a separate thread for progress reporting
+        auto startTime = chrono::steady_clock::now();
+        progressThread = thread([this, gcd, &progress, startTime]() {
+            const int PROGRESS_UPDATE_INTERVAL = 30; // seconds (changed from 15 to 30)
+            unique_lock<mutex> lock(progressMutex);
+            while (!progressWake.wait_for(lock, chrono::seconds(PROGRESS_UPDATE_INTERVAL), [&] { return !solverRunning; })) {
+                auto currentTime = chrono::steady_clock::now();
+                auto totalElapsed = chrono::duration_cast<chrono::seconds>(currentTime - startTime).count();
+                
+                cout << "Progress update - GCD: " << gcd 
+                     << ", Candidates tried: " << progress.candidateTries.load() 
+                     << ", Total time: " << totalElapsed << "s" << endl;
+                if (options.workerStats) {
+                    printStageUtilization(engine.workerTelemetry());
+                }
+                cout.flush(); // Force output to display
+            }
+        });
+    }
+    
+    void gcdExamined(uint32_t /*gcd*/) override {
+        if (options.histogramEvery > 0 && ++examined % options.histogramEvery == 0) {
+            printStageHistograms(engine.stageHistograms());
+        }
+    }
+    
+    void solveFinished(uint32_t gcd, const SolveResult& result) override {
+        // Stop the progress reporting thread
+        {
+            lock_guard<mutex> guard(progressMutex);
+            solverRunning = false;
+        }
+        progressWake.notify_all();
+        if (progressThread.joinable()) {
+            progressThread.join();
+        }
         
-        // Calculate remainder using modular arithmetic
-        int remainder = 0;
-        for (char c : opt) {
-            remainder = (remainder * 10 + (c - '0')) % candidateGCD;
+        totalOrderingMicros += result.orderingMicros;
+        if (!result.summary.empty()) {
+            cout << result.summary << endl;
+        }
+        if (!result.winner.empty()) {
+            portfolioWins[result.winner].wins++;
+            portfolioWins[result.winner].seconds += result.winnerSeconds;
+            if (!options.portfolioLog.empty()) {
+                ofstream log(options.portfolioLog, ios::app);
+                log << gcd << "," << result.winner << "," << result.winnerSeconds << ","
+                    << result.solutions.size() << "\n";
+            }
+        }
+        if (result.solutions.empty() && result.candidateTries > 0) {
+            cout << "Candidate GCD " << gcd << " yields no solutions after trying " 
+                 << result.candidateTries << " candidates (value ordering: " << result.orderingMicros << " us)." << endl;
+        }
+        
+        if (cached && result.solutions.empty() && result.exhausted) {
+            cached->frontier = gcd;
         }
         
-        if (remainder == 0) {
-            filtered.push_back(opt);
+        // Checkpoint the incremental state and the cached frontier now and then so a long sweep keeps its progress.
+        const int CHECKPOINT_INTERVAL = 300; // seconds
+        if (chrono::steady_clock::now() - lastCheckpoint > chrono::seconds(CHECKPOINT_INTERVAL)) {
+            if (state) state->save(options.incrementalState);
+            if (cache) cache->store(puzzle, *cached);
+            lastCheckpoint = chrono::steady_clock::now();
         }
     }
-    return filtered;
-}
+    
+    long long totalOrderingMicros = 0;
+    map<string, PortfolioTally> portfolioWins;
+    
+private:
+    const SolverOptions& options;
+    const Engine& engine;
+    const PuzzleDefinition& puzzle;
+    SweepState* state;
+    const ResultCache* cache;
+    CachedResult* cached;
+    chrono::steady_clock::time_point lastCheckpoint = chrono::steady_clock::now();
+    size_t examined = 0;
+    bool solverRunning = false;
+    mutex progressMutex;
+    condition_variable progressWake;
+    thread progressThread;
+};
 
-// Optimized version of filterByColumn using reserve for better performance
-vector<string> filterByColumn(const vector<string>& numbers, int column, char value) {
-    vector<string> filtered;
-    filtered.reserve(numbers.size() / 9); // Estimate capacity to avoid reallocations
-    for (const string& number : numbers) {
-        if (number[column] == value) {
-            filtered.push_back(number);
+void printSolutions(const SolverOptions& options, uint32_t gcd, const vector<array<uint32_t, 9>>& solutions) {
+    cout << "\nFound solution with GCD " << gcd << " (highest possible):" << endl;
+    if (options.config.firstSolution || options.config.restartUnit > 0) {
+        cout << "Stopped at the first solution." << endl;
+    } else {
+        cout << "The puzzle has " << solutions.size() << " solution(s)." << endl;
+    }
+    
+    int solCount = 0;
+    for (const auto &sol : solutions) {
+        solCount++;
+        cout << "\nSolution #" << solCount << ":" << endl;
+        for (int r = 0; r < 9; r++) {
+            cout << setw(9) << setfill('0') << sol[r] << "\n";
         }
+        
+        // Print the answer (middle row) as required by the Jane Street puzzle
+        cout << "\nJane Street Puzzle Answer (middle row): " << setw(9) << setfill('0') << sol[4] << endl;
     }
-    return filtered;
 }
 
-// Optimized version of filterDisallowedValues using reserve and a set for faster lookups
-vector<string> filterDisallowedValues(const vector<string>& numbers,
-                                      int column,
-                                      const vector<char>& disallowedValues)
-{
-    // Convert disallowedValues to a set for O(1) lookups
-    unordered_set<char> disallowedSet(disallowedValues.begin(), disallowedValues.end());
+//--------------------------------------------------------------------
+// Metrics endpoint
+//--------------------------------------------------------------------
+
+// Serves the engine's counters and worker telemetry as OpenMetrics text to every request on
+// a localhost TCP port or a Unix socket, from its own thread. Rates are over the time since
+// the previous scrape (or since the start, for the first one).
+class MetricsServer {
+public:
+    explicit MetricsServer(const Engine& engine) : engine(engine) {}
     
-    vector<string> filtered;
-    filtered.reserve(numbers.size()); // Reserve space to avoid reallocations
+    ~MetricsServer() {
+        stop();
+    }
     
-    for (const string& number : numbers) {
-        if (disallowedSet.find(number[column]) == disallowedSet.end()) {
-            filtered.push_back(number);
+    // Binds the endpoint and starts serving; false with a message on cerr if it can't.
+    bool start(const string& endpoint) {
+#if defined(__unix__)
+        if (endpoint.rfind("unix:", 0) == 0) {
+            socketPath = endpoint.substr(5);
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+                cerr << "Invalid metrics socket path: " << socketPath << endl;
+                return false;
+            }
+            strcpy(address.sun_path, socketPath.c_str());
+            unlink(socketPath.c_str());
+            listener = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                cerr << "Could not bind metrics socket " << socketPath << ": " << strerror(errno) << endl;
+                return false;
+            }
+        } else {
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(uint16_t(stoi(endpoint)));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                cerr << "Could not bind metrics port " << endpoint << ": " << strerror(errno) << endl;
+                return false;
+            }
+        }
+        if (listen(listener, 8) != 0) {
+            cerr << "Could not listen for metrics: " << strerror(errno) << endl;
+            return false;
+        }
+        running = true;
+        server = thread([this]() { serve(); });
+        return true;
+#else
+        cerr << "The metrics endpoint needs POSIX sockets: " << endpoint << endl;
+        return false;
+#endif
+    }
+    
+    void stop() {
+#if defined(__unix__)
+        running = false;
+        if (server.joinable()) {
+            server.join();
+        }
+        if (listener >= 0) {
+            close(listener);
+            listener = -1;
+        }
+        if (!socketPath.empty()) {
+            unlink(socketPath.c_str());
+            socketPath.clear();
+        }
+#endif
+    }
+    
+private:
+#if defined(__unix__)
+    void serve() {
+        while (running) {
+            pollfd waiting = {listener, POLLIN, 0};
+            if (poll(&waiting, 1, 200) <= 0) {
+                continue;
+            }
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            // Any request gets the metrics; the request itself is read and ignored.
+            char request[2048];
+            pollfd reading = {client, POLLIN, 0};
+            if (poll(&reading, 1, 1000) > 0) {
+                (void)recv(client, request, sizeof(request), 0);
+            }
+            string body = render();
+            string response = "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                              "Content-Length: " + to_string(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n" + body;
+            for (size_t sent = 0; sent < response.size();) {
+                ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += size_t(n);
+            }
+            close(client);
         }
     }
-    return filtered;
+#endif
+    
+    string render() {
+        SearchCounters counters = engine.searchCounters();
+        vector<WorkerTelemetry> workers = engine.workerTelemetry();
+        auto now = chrono::steady_clock::now();
+        double seconds = chrono::duration<double>(now - lastScrape).count();
+        double gcdRate = seconds > 0 ? (counters.gcdsExamined - lastGCDs) / seconds : 0;
+        double nodeRate = seconds > 0 ? (counters.nodes - lastNodes) / seconds : 0;
+        lastScrape = now;
+        lastGCDs = counters.gcdsExamined;
+        lastNodes = counters.nodes;
+        
+        ostringstream out;
+        out << "# TYPE sudoku_current_gcd gauge\n"
+            << "# HELP sudoku_current_gcd GCD being examined, 0 between searches.\n"
+            << "sudoku_current_gcd " << counters.currentGCD << "\n"
+            << "# TYPE sudoku_gcds_examined counter\n"
+            << "sudoku_gcds_examined_total " << counters.gcdsExamined << "\n"
+            << "# TYPE sudoku_gcds_per_second gauge\n"
+            << "sudoku_gcds_per_second " << gcdRate << "\n"
+            << "# TYPE sudoku_gcds_rejected counter\n"
+            << "# HELP sudoku_gcds_rejected GCDs ruled out, by stage (and first empty row for the divisibility filter).\n";
+        for (int r = 0; r < 9; r++) {
+            out << "sudoku_gcds_rejected_total{stage=\"divisibility\",row=\"" << r + 1 << "\"} "
+                << counters.emptyRow[r] << "\n";
+        }
+        out << "sudoku_gcds_rejected_total{stage=\"search\"} " << counters.infeasible << "\n"
+            << "# TYPE sudoku_gcds_solved counter\n"
+            << "# HELP sudoku_gcds_solved GCDs that reached the solver.\n"
+            << "sudoku_gcds_solved_total " << counters.solved << "\n"
+            << "# TYPE sudoku_gcds_reused counter\n"
+            << "sudoku_gcds_reused_total " << counters.reused << "\n"
+            << "# TYPE sudoku_nodes counter\n"
+            << "# HELP sudoku_nodes Candidate rows tried by the solvers.\n"
+            << "sudoku_nodes_total " << counters.nodes << "\n"
+            << "# TYPE sudoku_nodes_per_second gauge\n"
+            << "sudoku_nodes_per_second " << nodeRate << "\n"
+            << "# TYPE sudoku_resident_memory_bytes gauge\n"
+            << "sudoku_resident_memory_bytes " << residentBytes() << "\n"
+            << "# TYPE sudoku_worker_busy_seconds counter\n";
+        for (const WorkerTelemetry& worker : workers) {
+            out << "sudoku_worker_busy_seconds_total{stage=\"" << worker.stage << "\",worker=\"" << worker.worker
+                << "\"} " << worker.busySeconds << "\n";
+        }
+        out << "# TYPE sudoku_worker_idle_seconds counter\n";
+        for (const WorkerTelemetry& worker : workers) {
+            out << "sudoku_worker_idle_seconds_total{stage=\"" << worker.stage << "\",worker=\"" << worker.worker
+                << "\"} " << worker.idleSeconds << "\n";
+        }
+        out << "# TYPE sudoku_worker_utilization gauge\n"
+            << "# HELP sudoku_worker_utilization Busy share of the worker's time in its stage so far.\n";
+        for (const WorkerTelemetry& worker : workers) {
+            double total = worker.busySeconds + worker.idleSeconds;
+            out << "sudoku_worker_utilization{stage=\"" << worker.stage << "\",worker=\"" << worker.worker
+                << "\"} " << (total > 0 ? worker.busySeconds / total : 0.0) << "\n";
+        }
+        out << "# EOF\n";
+        return out.str();
+    }
+    
+    static long long residentBytes() {
+        ifstream statm("/proc/self/statm");
+        long long pages = 0, resident = 0;
+        statm >> pages >> resident;
+#if defined(__unix__)
+        return resident * sysconf(_SC_PAGESIZE);
+#else
+        return 0;
+#endif
+    }
+    
+    const Engine& engine;
+    int listener = -1;
+    string socketPath;
+    atomic<bool> running{false};
+    thread server;
+    chrono::steady_clock::time_point lastScrape = chrono::steady_clock::now();
+    unsigned long long lastGCDs = 0;
+    unsigned long long lastNodes = 0;
+};
+
+//--------------------------------------------------------------------
+// Synthetic corpus
+//--------------------------------------------------------------------
+
+// Writes synthCount puzzles per tier to the corpus directory (which must exist) as
+// <tier>-<n>.txt, with corpus.csv listing each one's planted GCD, clue counts and planted rows.
+// Tiers differ in clue density: fewer clues leave more rows, so each GCD costs more to search.
+bool writeSyntheticCorpus(const SolverOptions& options) {
+    struct Tier {
+        string name;
+        double givens;
+        double disallowed;
+    };
+    vector<Tier> tiers = {{"easy", 0.30, 0.20}, {"medium", 0.15, 0.10}, {"hard", 0.05, 0.05}};
+    if (options.synthGivens >= 0) {
+        tiers = {{"custom", options.synthGivens, options.synthDisallowed}};
+    }
+    ofstream manifest(options.synthesize + "/corpus.csv");
+    if (!manifest) {
+        cerr << "Could not write " << options.synthesize << "/corpus.csv" << endl;
+        return false;
+    }
+    manifest << "file,tier,requested_gcd,planted_gcd,givens,disallowed_cells,planted_rows\n";
+    uint64_t seed = options.config.seed;
+    for (const Tier& tier : tiers) {
+        for (int n = 1; n <= options.synthCount; n++) {
+            SyntheticPuzzle synthetic;
+            if (!generateSyntheticPuzzle(options.synthGCD, tier.givens, tier.disallowed, seed++, synthetic)) {
+                cerr << "No grid with every row a multiple of " << options.synthGCD << " was found." << endl;
+                return false;
+            }
+            string file = tier.name + "-" + to_string(n) + ".txt";
+            if (!savePuzzleDefinition(options.synthesize + "/" + file, synthetic.puzzle)) {
+                cerr << "Could not write " << options.synthesize << "/" << file << endl;
+                return false;
+            }
+            manifest << file << "," << tier.name << "," << options.synthGCD << "," << synthetic.plantedGCD << ","
+                     << synthetic.givens << "," << synthetic.disallowedCells << ",";
+            for (int r = 0; r < 9; r++) {
+                manifest << (r ? " " : "") << setw(9) << setfill('0') << synthetic.planted[r];
+            }
+            manifest << "\n";
+            cout << "Wrote " << file << ": planted GCD " << synthetic.plantedGCD << ", " << synthetic.givens
+                 << " given(s), " << synthetic.disallowedCells << " disallowed cell(s)." << endl;
+        }
+    }
+    return bool(manifest);
 }
 
+// Runs the sampling profiler for its lifetime and writes the profile on every way out of main.
+class ProfileSession {
+public:
+    explicit ProfileSession(const SolverOptions& options) : path(options.profileFile) {
+        if (path.empty()) return;
+        running = startProfiler(1000000 / options.profileHz);
+        if (!running) {
+            cerr << "The profiler needs setitimer and SIGPROF; --profile is ignored." << endl;
+        }
+    }
+    
+    ~ProfileSession() {
+        if (!running) return;
+        stopProfiler();
+        if (writeProfile(path)) {
+            cout << "Wrote profile " << path << endl;
+        } else {
+            cerr << "Could not write " << path << endl;
+        }
+    }
+    
+private:
+    string path;
+    bool running = false;
+};
+
 //--------------------------------------------------------------------
 // Main
 //--------------------------------------------------------------------
-int main() {
-    // STEP 1. Generate all valid 9-digit strings with one digit missing
-    vector<string> validNumbers;
-    vector<char> requiredDigits = {'0','2','5'};
+int main(int argc, char* argv[]) {
+    SolverOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
     
-    // Start timing for performance measurement
-    auto startGenTime = chrono::steady_clock::now();
+    // The engine resolves the SIMD kernel set once; every stage below calls through it.
+    Engine engine(options.config);
+    cout << engine.kernelReport() << endl;
+    ProfileSession profile(options);
     
-    // Create a mutex for thread-safe vector access
-    mutex validNumbersMutex;
+    if (options.selfCheck > 0) {
+        SelfCheckReport report = runSelfCheck(options.config.seed, options.selfCheck);
+        for (const string& failure : report.failures) {
+            cout << "MISMATCH " << failure << endl;
+        }
+        cout << "Self-check: " << report.cases << " comparisons over " << options.selfCheck << " iterations, "
+             << report.failures.size() << " mismatch(es)." << endl;
+        return report.failures.empty() ? 0 : 1;
+    }
     
-    // Determine number of threads to use (leave one core free)
-    unsigned int numThreads = max(1u, thread::hardware_concurrency() - 1);
-    cout << "Using " << numThreads << " threads for permutation generation." << endl;
+    if (!options.synthesize.empty()) {
+        return writeSyntheticCorpus(options) ? 0 : 1;
+    }
     
-    // Vector to hold our threads
-    vector<thread> threads;
+    // STEP 1. Generate all valid 9-digit strings with one digit missing
+    PuzzleDefinition puzzle = january2025Puzzle();
+    if (!options.puzzleFile.empty()) {
+        string error;
+        if (!loadPuzzleDefinition(options.puzzleFile, puzzle, error)) {
+            cerr << "Invalid puzzle definition: " << error << endl;
+            return 1;
+        }
+        cout << "Puzzle definition: " << options.puzzleFile << endl;
+    }
+    if (!options.savePuzzle.empty() && !savePuzzleDefinition(options.savePuzzle, puzzle)) {
+        cerr << "Could not write " << options.savePuzzle << endl;
+    }
+    if (options.benchScaling > 0) {
+        vector<int> threadCounts;
+        for (int threads = 1; threads < options.benchScaling; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(options.benchScaling);
+        printScalingTables(runScalingBenchmark(threadCounts, puzzle));
+        return 0;
+    }
+    cout << "Row symmetries of the puzzle: " << rowSymmetries(puzzle).size()
+         << " (instances can add more where divisibility leaves rows with equal candidates)." << endl;
     
-    // Try skipping each digit (0-9) one at a time
-    for (char skipDigit = '0'; skipDigit <= '9'; skipDigit++) {
-        // Skip this iteration if the digit we want to skip is a required digit
-        if (find(requiredDigits.begin(), requiredDigits.end(), skipDigit) != requiredDigits.end()) {
-            cout << "Skipping digit '" << skipDigit << "' is not allowed as it's a required digit." << endl;
-            continue;
+    // A cached sweep of the same puzzle answers outright or tells where its proven frontier is.
+    unique_ptr<ResultCache> cache;
+    CachedResult cached;
+    int startGCD = options.maxGCD;
+    if (!options.cacheDir.empty()) {
+        cache.reset(new ResultCache(options.cacheDir));
+        bool found = cache->lookup(puzzle, cached);
+        bool usable = found && cached.searchedFrom >= uint32_t(options.maxGCD) &&
+                      cached.bestGCD <= uint32_t(options.maxGCD);
+        if (usable && cached.bestGCD >= uint32_t(max(options.minGCD, 1)) &&
+            (cached.complete || options.config.firstSolution)) {
+            cout << "Result cache hit: " << cache->path(puzzle) << endl;
+            printSolutions(options, cached.bestGCD, cached.solutions);
+            return 0;
         }
-        
-        // Create a string with all digits except the one we're skipping
-        string digits;
-        for (char d = '0'; d <= '9'; d++) {
-            if (d != skipDigit) {
-                digits.push_back(d);
-            }
+        if (usable && cached.frontier <= uint32_t(options.maxGCD)) {
+            // Everything above the frontier is settled; the frontier itself is re-examined
+            // when it holds the best GCD without the full solution set.
+            startGCD = cached.bestGCD ? int(cached.bestGCD) : int(cached.frontier) - 1;
+            cout << "Result cache: GCDs " << options.maxGCD << " down to " << startGCD + 1
+                 << " already examined; resuming at " << startGCD << "." << endl;
+        } else if (found) {
+            // The cached sweep covers a different range; keep it rather than overwrite it.
+            cout << "Result cache entry " << cache->path(puzzle) << " doesn't cover this GCD range." << endl;
+            cache.reset();
+        } else {
+            cached.searchedFrom = uint32_t(options.maxGCD);
+            cached.frontier = uint32_t(options.maxGCD) + 1;
+            cout << "Result cache miss: " << cache->path(puzzle) << endl;
         }
+    }
+    
+    // A build with embedded tables for this puzzle skips steps 1 and 2 entirely.
+    auto startLoadTime = chrono::steady_clock::now();
+    if (options.emitTables.empty() && engine.loadEmbeddedRows(puzzle)) {
+        cout << "Loaded embedded row tables in "
+             << chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startLoadTime).count()
+             << " us." << endl;
+    } else {
+        // Determine number of threads to use (leave one core free unless told otherwise)
+        unsigned int numThreads = options.threads ? options.threads : max(1u, thread::hardware_concurrency() - 1);
+        cout << "Using " << numThreads << " threads for permutation generation." << endl;
         
-        // Sort to prepare for permutation
-        sort(digits.begin(), digits.end());
-        
-        // Create a thread to process this digit's permutations
-        threads.emplace_back([digits, requiredDigits, skipDigit, &validNumbersMutex, &validNumbers]() {
-            vector<string> localValidNumbers;
-            string localDigits = digits;
-            
-            // Generate all permutations that contain the required digits
-            size_t count = 0;
-            do {
-                if (containsRequiredDigits(localDigits, requiredDigits)) {
-                    localValidNumbers.push_back(localDigits);
-                }
-                count++;
-            } while (next_permutation(localDigits.begin(), localDigits.end()));
-            
-            // Now merge the local results with the global results
-            {
-                lock_guard<mutex> guard(validNumbersMutex);
-                validNumbers.insert(validNumbers.end(), localValidNumbers.begin(), localValidNumbers.end());
-                cout << "Skipping digit '" << skipDigit << "' generated " 
-                     << localValidNumbers.size() << " valid strings from " << count << " permutations." << endl;
+        GenerationStats generation = engine.generate(puzzle.requiredDigits, numThreads);
+        for (const GenerationStats::Digit& digit : generation.digits) {
+            if (digit.skipped) {
+                cout << "Skipping digit '" << digit.skipDigit << "' is not allowed as it's a required digit." << endl;
+            } else {
+                cout << "Skipping digit '" << digit.skipDigit << "' generated " 
+                     << digit.validStrings << " valid strings from " << digit.permutations << " permutations." << endl;
             }
-        });
+        }
+        cout << "Generated " << generation.total << " valid 9-digit strings in " 
+             << generation.milliseconds << " ms." << endl;
         
-        // If we've reached our thread limit or this is the last digit, wait for threads to complete
-        if (threads.size() >= numThreads || skipDigit == '9') {
-            for (auto& t : threads) {
-                if (t.joinable()) {
-                    t.join();
-                }
-            }
-            threads.clear();
-        }
-    }
-    
-    // Make sure all threads are joined
-    for (auto& t : threads) {
-        if (t.joinable()) {
-            t.join();
-        }
-    }
-    
-    auto endGenTime = chrono::steady_clock::now();
-    auto genDuration = chrono::duration_cast<chrono::milliseconds>(endGenTime - startGenTime).count();
-    cout << "Generated " << validNumbers.size() << " valid 9-digit strings in " 
-         << genDuration << " ms." << endl;
-    
-    // STEP 2. Build the base puzzle (row candidate lists) using your filtering functions.
-    // (Positions use 0-indexing.)
-    vector<vector<string>> puzzle(9);
-    
-    // Row1: fixed clue: column8 (index 7) must be '2'
-    {
-        vector<string> row1Options = filterByColumn(validNumbers, 7, '2');
-        row1Options = filterDisallowedValues(row1Options, 2, {'0'});
-        row1Options = filterDisallowedValues(row1Options, 4, {'0'});
-        row1Options = filterDisallowedValues(row1Options, 6, {'5'});
-        row1Options = filterDisallowedValues(row1Options, 8, {'5'});
-        puzzle[0] = row1Options;
-    }
-    // Row2: fixed clues: column5 (index 4) is '2' and column9 (index 8) is '5'
-    {
-        vector<string> row2Options = filterByColumn(validNumbers, 4, '2');
-        row2Options = filterByColumn(row2Options, 8, '5');
-        row2Options = filterDisallowedValues(row2Options, 2, {'0'});
-        row2Options = filterDisallowedValues(row2Options, 4, {'0'});
-        puzzle[1] = row2Options;
-    }
-    // Row3: fixed clue: column2 (index 1) is '2'
-    {
-        vector<string> row3Options = filterByColumn(validNumbers, 1, '2');
-        row3Options = filterDisallowedValues(row3Options, 2, {'0'});
-        row3Options = filterDisallowedValues(row3Options, 4, {'0'});
-        row3Options = filterDisallowedValues(row3Options, 6, {'5'});
-        row3Options = filterDisallowedValues(row3Options, 7, {'5'});
-        row3Options = filterDisallowedValues(row3Options, 8, {'5'});
-        puzzle[2] = row3Options;
-    }
-    // Row4: fixed clue: column3 (index 2) is '0'
-    {
-        vector<string> row4Options = filterByColumn(validNumbers, 2, '0');
-        row4Options = filterDisallowedValues(row4Options, 1, {'2'});
-        row4Options = filterDisallowedValues(row4Options, 3, {'2'});
-        row4Options = filterDisallowedValues(row4Options, 4, {'2'});
-        row4Options = filterDisallowedValues(row4Options, 5, {'2'});
-        row4Options = filterDisallowedValues(row4Options, 7, {'2'});
-        row4Options = filterDisallowedValues(row4Options, 6, {'5'});
-        row4Options = filterDisallowedValues(row4Options, 8, {'5'});
-        puzzle[3] = row4Options;
-    }
-    // Row5: no fixed digit, but some disallowed columns
-    {
-        vector<string> row5Options = validNumbers;
-        row5Options = filterDisallowedValues(row5Options, 0, {'0'});
-        row5Options = filterDisallowedValues(row5Options, 1, {'0','2'});
-        row5Options = filterDisallowedValues(row5Options, 2, {'0'});
-        row5Options = filterDisallowedValues(row5Options, 4, {'0','2'});
-        row5Options = filterDisallowedValues(row5Options, 6, {'5'});
-        row5Options = filterDisallowedValues(row5Options, 8, {'5'});
-        puzzle[4] = row5Options;
-    }
-    // Row6: fixed clue: column4 (index 3) is '2'
-    {
-        vector<string> row6Options = filterByColumn(validNumbers, 3, '2');
-        row6Options = filterDisallowedValues(row6Options, 0, {'0'});
-        row6Options = filterDisallowedValues(row6Options, 1, {'0'});
-        row6Options = filterDisallowedValues(row6Options, 2, {'0'});
-        row6Options = filterDisallowedValues(row6Options, 4, {'0'});
-        row6Options = filterDisallowedValues(row6Options, 6, {'5'});
-        row6Options = filterDisallowedValues(row6Options, 8, {'5'});
-        puzzle[5] = row6Options;
-    }
-    // Row7: fixed clue: column5 (index 4) is '0'
-    {
-        vector<string> row7Options = filterByColumn(validNumbers, 4, '0');
-        row7Options = filterDisallowedValues(row7Options, 1, {'2'});
-        row7Options = filterDisallowedValues(row7Options, 3, {'2'});
-        row7Options = filterDisallowedValues(row7Options, 5, {'2'});
-        row7Options = filterDisallowedValues(row7Options, 7, {'2'});
-        row7Options = filterDisallowedValues(row7Options, 6, {'5'});
-        row7Options = filterDisallowedValues(row7Options, 7, {'5'});
-        row7Options = filterDisallowedValues(row7Options, 8, {'5'});
-        puzzle[6] = row7Options;
-    }
-    // Row8: fixed clue: column6 (index 5) is '2'
-    {
-        vector<string> row8Options = filterByColumn(validNumbers, 5, '2');
-        row8Options = filterDisallowedValues(row8Options, 2, {'0'});
-        row8Options = filterDisallowedValues(row8Options, 3, {'0'});
-        row8Options = filterDisallowedValues(row8Options, 4, {'0'});
-        row8Options = filterDisallowedValues(row8Options, 6, {'5'});
-        row8Options = filterDisallowedValues(row8Options, 7, {'5'});
-        row8Options = filterDisallowedValues(row8Options, 8, {'5'});
-        puzzle[7] = row8Options;
-    }
-    // Row9: fixed clue: column7 (index 6) is '5'
-    {
-        vector<string> row9Options = filterByColumn(validNumbers, 6, '5');
-        row9Options = filterDisallowedValues(row9Options, 1, {'2'});
-        row9Options = filterDisallowedValues(row9Options, 3, {'2'});
-        row9Options = filterDisallowedValues(row9Options, 4, {'2'});
-        row9Options = filterDisallowedValues(row9Options, 5, {'2'});
-        row9Options = filterDisallowedValues(row9Options, 7, {'2'});
-        row9Options = filterDisallowedValues(row9Options, 2, {'0'});
-        row9Options = filterDisallowedValues(row9Options, 3, {'0'});
-        row9Options = filterDisallowedValues(row9Options, 4, {'0'});
-        row9Options = filterDisallowedValues(row9Options, 5, {'0'});
-        puzzle[8] = row9Options;
+        // STEP 2. Build the base puzzle (row candidate lists) from per-column digit masks.
+        engine.filterRows(puzzle.rowMasks);
+    }
+    
+    if (!options.emitTables.empty()) {
+        if (!engine.writeRowTables(options.emitTables)) {
+            cerr << "Could not write " << options.emitTables << endl;
+            return 1;
+        }
+        cout << "Wrote row tables to " << options.emitTables << "." << endl;
+        return 0;
     }
     
     // Print the number of candidate options per row from the base puzzle.
     for (int r = 0; r < 9; r++) {
-        cout << "Row " << r+1 << " has " << puzzle[r].size() << " candidate(s) (before GCD filtering)." << endl;
+        cout << "Row " << r+1 << " has " << engine.rowSize(r) << " candidate(s) (before GCD filtering)." << endl;
     }
     
-    // STEP 3. Convert candidate strings to vectors of digits.
-    // We'll keep the base candidates (before the candidate-GCD filtering) in "puzzle".
-    // (We will re-filter for each candidate GCD below.)
-    // For convenience, we save the base puzzle in "basePuzzle" (as a copy).
-    vector<vector<string>> basePuzzle = puzzle;
-    
     // Optimize GCD candidate search - for Jane Street puzzle, we want to maximize the GCD
     // We'll cycle over candidate GCD values from highest to lowest for efficiency
     // Only try those that end in 1, 3, 7, or 9 (as these are coprime to 10)
-    vector<int> candidateGCDs;
-    for (int candidateGCD = 12345678; candidateGCD >= 337; candidateGCD--) {
+    // Digit-sum and alternating-sum congruences rule out whole classes of multiples as well.
+    vector<uint32_t> excluded = engine.invariantExclusions();
+    vector<uint32_t> candidateGCDs;
+    size_t invariantSkipped = 0;
+    for (int candidateGCD = startGCD; candidateGCD >= options.minGCD; candidateGCD--) {
         int lastDigit = candidateGCD % 10;
         if (lastDigit == 1 || lastDigit == 3 || lastDigit == 7 || lastDigit == 9) {
-            candidateGCDs.push_back(candidateGCD);
+            bool ruledOut = false;
+            for (uint32_t q : excluded) ruledOut = ruledOut || candidateGCD % q == 0;
+            if (ruledOut) {
+                invariantSkipped++;
+            } else {
+                candidateGCDs.push_back(uint32_t(candidateGCD));
+            }
         }
     }
+    if (!excluded.empty()) {
+        cout << "Invariant prefilter: no grid has every row divisible by";
+        for (size_t i = 0; i < excluded.size(); i++) {
+            cout << (i ? ", " : " ") << excluded[i];
+        }
+        cout << "; skipping " << invariantSkipped << " of their multiples." << endl;
+    }
     
     cout << "Testing " << candidateGCDs.size() << " candidate GCDs in descending order." << endl;
     
-    for (int candidateGCD : candidateGCDs) {
-        // Create a new puzzle filtered by candidateGCD.
-        vector<vector<string>> candidatePuzzle = basePuzzle;
-        bool validCandidate = true;
-        for (int r = 0; r < 9; r++) {
-            candidatePuzzle[r] = filterDivisibleByCandidate(candidatePuzzle[r], candidateGCD);
-            if (candidatePuzzle[r].empty()) {
-                validCandidate = false;
-                break;
-            }
+    // Results of earlier runs that the differences from their puzzle definition can't have changed.
+    SweepState state;
+    SweepState* incremental = nullptr;
+    if (!options.incrementalState.empty()) {
+        incremental = &state;
+        if (state.load(options.incrementalState)) {
+            size_t recorded = state.recordedCount();
+            size_t dropped = state.rebase(puzzle);
+            cout << "Incremental state " << options.incrementalState << ": " << recorded
+                 << " recorded GCD result(s), " << dropped << " invalidated by puzzle edits." << endl;
+        } else {
+            state.puzzle = puzzle;
+            cout << "Incremental state " << options.incrementalState << " not found; starting a new one." << endl;
         }
-        if (!validCandidate) continue;
-        
-        // For each row, convert candidate strings to vectors of digits.
-        vector<vector<vector<int>>> candidates(9);
-        for (int r = 0; r < 9; r++) {
-            for (const string &s : candidatePuzzle[r]) {
-                vector<int> cand;
-                for (char c : s) {
-                    cand.push_back(c - '0');
-                }
-                candidates[r].push_back(cand);
-            }
+    }
+    
+    unique_ptr<MetricsServer> metrics;
+    if (!options.metrics.empty()) {
+        metrics.reset(new MetricsServer(engine));
+        if (!metrics->start(options.metrics)) {
+            return 1;
         }
-        
-        // We'll use a fixed ordering based on our candidate counts.
-        vector<int> rowOrder = { 1, 8, 5, 3, 6, 7, 2, 0, 4 }; // 0-indexed row indices
-        
-        // Initialize constraint masks and solution grid.
-        array<int, 9> colMask = {0,0,0,0,0,0,0,0,0};
-        array<int, 9> boxMask = {0,0,0,0,0,0,0,0,0};
-        vector<vector<int>> solution(9, vector<int>(9, 0));
-        vector<vector<vector<int>>> allSolutions;
-        
-        unsigned long long candidateTries = 0;
-        auto startTime = chrono::steady_clock::now();
-        auto lastProgressUpdate = startTime;
-        const int PROGRESS_UPDATE_INTERVAL = 30; // seconds (changed from 15 to 30)
-        
-        // Set up a separate thread for progress reporting
-        bool solverRunning = true;
-        cout << "Starting solver for GCD " << candidateGCD << "..." << endl;
-        
-        auto progressThread = thread([&]() {
-            while (solverRunning) {
-                this_thread::sleep_for(chrono::seconds(PROGRESS_UPDATE_INTERVAL));
-                auto currentTime = chrono::steady_clock::now();
-                auto totalElapsed = chrono::duration_cast<chrono::seconds>(currentTime - startTime).count();
-                
-                cout << "Progress update - GCD: " << candidateGCD 
-                     << ", Candidates tried: " << candidateTries 
-                     << ", Total time: " << totalElapsed << "s" << endl;
-                cout.flush(); // Force output to display
-            }
-        });
-        
-        // Helper lambda: check if at least one of the first columns has a 0
-        auto hasZeroInFirstColumns = [&solution]() -> bool {
-            // Check for any 0 in first three columns
-            for (int c = 0; c < 3; c++) {
-                for (int r = 0; r < 9; r++) {
-                    if (solution[r][c] == 0) {
-                        return true;
-                    }
-                }
-            }
-            return false;
-        };
-        
-        // Helper lambda: return the 3x3 box index for cell (r, c)
-        auto getBoxIndex = [](int r, int c) -> int {
-            return (r / 3) * 3 + (c / 3);
-        };
-        
-        // Precompute box indices for each cell to avoid repeated calculations
-        array<array<int, 9>, 9> boxIndices;
-        for (int r = 0; r < 9; r++) {
-            for (int c = 0; c < 9; c++) {
-                boxIndices[r][c] = getBoxIndex(r, c);
-            }
+        cout << "Serving OpenMetrics on " << (options.metrics.rfind("unix:", 0) == 0 ? options.metrics
+                                              : "http://127.0.0.1:" + options.metrics + "/metrics") << endl;
+    }
+    
+    // STEPS 3-4. Divisibility filtering and search, from the highest GCD down.
+    ConsoleObserver observer(options, engine, puzzle, incremental, cache.get(), cache ? &cached : nullptr);
+    SearchOutcome outcome = engine.search(candidateGCDs, &observer, incremental);
+    
+    if (incremental) {
+        cout << "Reused " << outcome.reusedResults << " GCD result(s) from the incremental state." << endl;
+        if (!state.save(options.incrementalState)) {
+            cerr << "Could not write " << options.incrementalState << endl;
         }
-        
-        // Recursive backtracking using the fixed ordering.
-        function<void(int)> solveFixed = [&](int pos) {
-            // Remove the timing-based progress reporting from here
-            
-            if (pos == 9) {
-                // Verify we have at least one 0 in the first columns before accepting the solution
-                if (hasZeroInFirstColumns()) {
-                    allSolutions.push_back(solution);
-                }
-                return;
-            }
-            
-            int r = rowOrder[pos];
-            
-            for (const auto &cand : candidates[r]) {
-                candidateTries++;
-                
-                // Fast conflict check using bitmasks
-                bool conflict = false;
-                
-                // Unrolled loop optimization for first few checks which are most likely to fail
-                if (true) {  // Always execute first check
-                    int d = cand[0];
-                    int b = boxIndices[r][0];
-                    if ((colMask[0] & (1 << d)) || (boxMask[b] & (1 << d))) {
-                        conflict = true;
-                    }
-                }
-                
-                if (!conflict) {  // Only check second column if first didn't conflict
-                    int d = cand[1];
-                    int b = boxIndices[r][1];
-                    if ((colMask[1] & (1 << d)) || (boxMask[b] & (1 << d))) {
-                        conflict = true;
-                    }
-                }
-                
-                // Check remaining columns if no conflict found
-                if (!conflict) {
-                    for (int c = 2; c < 9; c++) {
-                        int d = cand[c];
-                        int b = boxIndices[r][c];
-                        if ((colMask[c] & (1 << d)) || (boxMask[b] & (1 << d))) {
-                            conflict = true;
-                            break;
-                        }
-                    }
-                }
-                
-                if (conflict) continue;
-                
-                // Save old masks for backtracking
-                array<int, 9> oldColMask = colMask;
-                array<int, 9> oldBoxMask = boxMask;
-                
-                // Update masks and solution
-                for (int c = 0; c < 9; c++) {
-                    int d = cand[c];
-                    colMask[c] |= (1 << d);
-                    boxMask[boxIndices[r][c]] |= (1 << d);
-                    solution[r][c] = d;
-                }
-                
-                solveFixed(pos + 1);
-                
-                // Restore masks for backtracking
-                colMask = oldColMask;
-                boxMask = oldBoxMask;
-            }
-        };
-        
-        solveFixed(0);
-        
-        // Stop the progress reporting thread
-        solverRunning = false;
-        if (progressThread.joinable()) {
-            progressThread.join();
+    }
+    
+    if (cache) {
+        if (outcome.found) {
+            cached.bestGCD = cached.frontier = outcome.gcd;
+            cached.solutions = outcome.result.solutions;
+            cached.complete = outcome.result.exhausted;
+        } else if (!candidateGCDs.empty()) {
+            cached.frontier = candidateGCDs.back();
+        }
+        if (!cache->store(puzzle, cached)) {
+            cerr << "Could not write " << cache->path(puzzle) << endl;
+        }
+    }
+    
+    if (outcome.found) {
+        const SolveResult& result = outcome.result;
+        if (outcome.reused) {
+            cout << "\nTaken from the incremental state." << endl;
         }
+        printSolutions(options, outcome.gcd, result.solutions);
         
-        if (!allSolutions.empty()) {
-            cout << "\nFound solution with GCD " << candidateGCD << " (highest possible):" << endl;
-            cout << "The puzzle has " << allSolutions.size() << " solution(s)." << endl;
-            
-            int solCount = 0;
-            for (const auto &sol : allSolutions) {
-                solCount++;
-                cout << "\nSolution #" << solCount << ":" << endl;
-                for (int r = 0; r < 9; r++) {
-                    for (int c = 0; c < 9; c++) {
-                        cout << sol[r][c];
-                    }
-                    cout << "\n";
-                }
-                
-                // Print the answer (middle row) as required by the Jane Street puzzle
-                cout << "\nJane Street Puzzle Answer (middle row): ";
-                for (int c = 0; c < 9; c++) {
-                    cout << sol[4][c];
-                }
-                cout << endl;
-            }
-            
-            cout << "\nFor GCD " << candidateGCD 
-                 << ", total candidate rows tried: " << candidateTries << endl;
-            
-            // Since we're searching from highest to lowest GCD, we can break after finding the first valid solution
-            break;
-        } else {
-            if (candidateTries > 0) {
-                cout << "Candidate GCD " << candidateGCD << " yields no solutions after trying " 
-                     << candidateTries << " candidates." << endl;
-            }
+        cout << "\nFor GCD " << outcome.gcd 
+             << ", total candidate rows tried: " << result.candidateTries
+             << " (value ordering: " << result.orderingMicros << " us this GCD, "
+             << observer.totalOrderingMicros << " us in total)" << endl;
+    }
+    
+    if (!observer.portfolioWins.empty()) {
+        cout << "\nPortfolio wins by configuration:" << endl;
+        for (const auto& entry : observer.portfolioWins) {
+            cout << "  " << entry.first << ": " << entry.second.wins << " win(s), "
+                 << entry.second.seconds << " s to answer in total" << endl;
         }
     }
     
+    if (options.histograms) {
+        cout << endl;
+        printStageHistograms(engine.stageHistograms());
+    }
+    if (options.workerStats) {
+        printWorkerTelemetry(engine.workerTelemetry());
+    }
+    if (!options.traceFile.empty() && !engine.writeTrace(options.traceFile)) {
+        cerr << "Could not write " << options.traceFile << endl;
+    }
+    
     return 0;
 }
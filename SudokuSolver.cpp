@@ -0,0 +1,4719 @@
+#include "SudokuSolver.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <functional>
+#include <chrono>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <random>
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <memory>
+#include <deque>
+#include <iomanip>
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__unix__)
+#include <signal.h>
+#include <sys/time.h>
+#endif
+#if defined(SUDOKU_USE_LIBNUMA)
+#include <numa.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SUDOKU_X86_KERNELS 1
+#endif
+
+// USDT tracepoints (provider "sudoku") where <sys/sdt.h> is available, unless built with
+// -DSUDOKU_NO_USDT. An unattached probe is a single nop; without the header they compile away.
+#if !defined(SUDOKU_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SUDOKU_USDT 1
+#endif
+#endif
+#if defined(SUDOKU_USDT)
+#define SUDOKU_PROBE1(name, a) DTRACE_PROBE1(sudoku, name, a)
+#define SUDOKU_PROBE2(name, a, b) DTRACE_PROBE2(sudoku, name, a, b)
+#define SUDOKU_PROBE3(name, a, b, c) DTRACE_PROBE3(sudoku, name, a, b, c)
+#define SUDOKU_PROBE4(name, a, b, c, d) DTRACE_PROBE4(sudoku, name, a, b, c, d)
+#else
+#define SUDOKU_PROBE1(name, a) ((void)0)
+#define SUDOKU_PROBE2(name, a, b) ((void)0)
+#define SUDOKU_PROBE3(name, a, b, c) ((void)0)
+#define SUDOKU_PROBE4(name, a, b, c, d) ((void)0)
+#endif
+using namespace std;
+
+//--------------------------------------------------------------------
+// Solver library: generation, filtering, divisibility and search stages behind
+// sudoku::Engine (see SudokuSolver.h).
+//--------------------------------------------------------------------
+
+namespace sudoku {
+
+//--------------------------------------------------------------------
+// Helper functions (from your code)
+//--------------------------------------------------------------------
+
+// 1) Check if a number (9-char string) contains specific required digits
+bool containsRequiredDigits(const string& number, const vector<char>& requiredDigits) {
+    // Use a bit mask for faster checking
+    int digitMask = 0;
+    for (char c : number) {
+        digitMask |= (1 << (c - '0'));
+    }
+    
+    for (char digit : requiredDigits) {
+        if ((digitMask & (1 << (digit - '0'))) == 0) {
+            return false; // Missing a required digit
+        }
+    }
+    return true;
+}
+
+// 2) Given a list of candidate strings, filter and keep only those divisible by candidateGCD.
+vector<string> filterDivisibleByCandidate(const vector<string>& options, int candidateGCD) {
+    vector<string> filtered;
+    filtered.reserve(options.size() / 2); // Estimate capacity to avoid reallocations
+    
+    // Use a faster method for checking divisibility
+    // For large numbers, we can use modular arithmetic instead of full conversion
+    for (const string& opt : options) {
+        // For 9-digit numbers, we can use a more efficient approach
+        // than converting the entire string to a long long
+        
+        // Calculate remainder using modular arithmetic
+        int remainder = 0;
+        for (char c : opt) {
+            remainder = (remainder * 10 + (c - '0')) % candidateGCD;
+        }
+        
+        if (remainder == 0) {
+            filtered.push_back(opt);
+        }
+    }
+    return filtered;
+}
+
+// Optimized version of filterByColumn using reserve for better performance
+vector<string> filterByColumn(const vector<string>& numbers, int column, char value) {
+    vector<string> filtered;
+    filtered.reserve(numbers.size() / 9); // Estimate capacity to avoid reallocations
+    for (const string& number : numbers) {
+        if (number[column] == value) {
+            filtered.push_back(number);
+        }
+    }
+    return filtered;
+}
+
+// Optimized version of filterDisallowedValues using reserve and a set for faster lookups
+vector<string> filterDisallowedValues(const vector<string>& numbers,
+                                      int column,
+                                      const vector<char>& disallowedValues)
+{
+    // Convert disallowedValues to a set for O(1) lookups
+    unordered_set<char> disallowedSet(disallowedValues.begin(), disallowedValues.end());
+    
+    vector<string> filtered;
+    filtered.reserve(numbers.size()); // Reserve space to avoid reallocations
+    
+    for (const string& number : numbers) {
+        if (disallowedSet.find(number[column]) == disallowedSet.end()) {
+            filtered.push_back(number);
+        }
+    }
+    return filtered;
+}
+
+//--------------------------------------------------------------------
+// Packed candidate layouts used by the kernels below
+//--------------------------------------------------------------------
+
+// Conflict bits for one row candidate. Bit (c*10 + d) marks digit d in column c and
+// bit (90 + (c/3)*10 + d) marks digit d in the candidate's (c/3)-th box of its band.
+// A candidate conflicts with the rows placed so far iff its bits intersect theirs.
+struct CandidateBits {
+    uint64_t lo;
+    uint64_t hi;
+};
+
+// Bits 64..89 (the column part of the high word); everything above belongs to the boxes.
+const uint64_t COLUMN_BITS_HI_MASK = (1ULL << 26) - 1;
+
+inline void setConflictBit(CandidateBits& bits, int bit) {
+    if (bit < 64) {
+        bits.lo |= 1ULL << bit;
+    } else {
+        bits.hi |= 1ULL << (bit - 64);
+    }
+}
+
+CandidateBits makeCandidateBits(const string& number) {
+    CandidateBits bits = {0, 0};
+    for (int c = 0; c < 9; c++) {
+        int d = number[c] - '0';
+        setConflictBit(bits, c * 10 + d);
+        setConflictBit(bits, 90 + (c / 3) * 10 + d);
+    }
+    return bits;
+}
+
+uint32_t numberValue(const string& number) {
+    uint32_t value = 0;
+    for (char c : number) {
+        value = value * 10 + uint32_t(c - '0');
+    }
+    return value;
+}
+
+// The 9-digit string of a row value, with its leading zero if it has one.
+string numberDigits(uint32_t value) {
+    string number(9, '0');
+    for (int i = 8; i >= 0; i--, value /= 10) {
+        number[i] = char('0' + value % 10);
+    }
+    return number;
+}
+
+// The digit a row value leaves out (the smallest one, should it have repeated digits).
+int missingDigit(uint32_t value) {
+    int present = 0;
+    for (int c = 0; c < 9; c++, value /= 10) {
+        present |= 1 << (value % 10);
+    }
+    return __builtin_ctz(~present & ALL_DIGITS_MASK);
+}
+
+// Divisibility by d without a division per value (Hacker's Delight 10-17): write
+// d = odd * 2^shift, then n is a multiple of d iff rotr(n * inverse(odd), shift) <= (2^32-1)/d.
+struct DivisibilityTest {
+    uint32_t inverse;
+    uint32_t limit;
+    uint32_t shift;
+};
+
+DivisibilityTest makeDivisibilityTest(uint32_t divisor) {
+    DivisibilityTest test;
+    test.shift = 0;
+    uint32_t odd = divisor;
+    while ((odd & 1) == 0) {
+        odd >>= 1;
+        test.shift++;
+    }
+    // Newton iteration; each step doubles the number of correct low bits (3 -> 6 -> 12 -> 24 -> 48).
+    uint32_t inverse = odd;
+    for (int i = 0; i < 4; i++) {
+        inverse *= 2 - odd * inverse;
+    }
+    test.inverse = inverse;
+    test.limit = 0xFFFFFFFFu / divisor;
+    return test;
+}
+
+inline bool isDivisible(uint32_t value, const DivisibilityTest& test) {
+    uint32_t x = value * test.inverse;
+    if (test.shift != 0) {
+        x = (x >> test.shift) | (x << (32 - test.shift));
+    }
+    return x <= test.limit;
+}
+
+// Row validation by 3-digit chunks. A value below 10^9 splits into columns 0-2, 3-5 and 6-8
+// with two multiply-shift divisions, and each chunk's digit mask comes from a 1000-entry
+// table built from the row's column masks; a chunk with a repeated digit or a digit its
+// column doesn't allow maps to CHUNK_INVALID. The value is a valid row iff the three masks
+// are valid and disjoint (nine distinct digits) and cover the required digits.
+const uint32_t CHUNK_INVALID = 1u << 10;
+
+struct DigitTables {
+    uint32_t chunks[3][1000];
+    uint32_t required;                      // required digits, bit d for digit d
+};
+
+void buildDigitTables(const uint16_t* columnMasks, uint32_t requiredMask, DigitTables& tables) {
+    for (int k = 0; k < 3; k++) {
+        for (int chunk = 0; chunk < 1000; chunk++) {
+            int digits[3] = {chunk / 100, chunk / 10 % 10, chunk % 10};
+            uint32_t mask = 0;
+            for (int i = 0; i < 3; i++) {
+                uint32_t bit = 1u << digits[i];
+                if ((mask & bit) || !(columnMasks[3 * k + i] & bit)) {
+                    mask = CHUNK_INVALID;
+                    break;
+                }
+                mask |= bit;
+            }
+            tables.chunks[k][chunk] = mask;
+        }
+    }
+    tables.required = requiredMask;
+}
+
+// v / 1000 and v / 1000000 for any 32-bit v (the reciprocals compilers use).
+inline uint32_t divide1000(uint32_t v) {
+    return uint32_t((uint64_t(v) * 0x10624DD3u) >> 38);
+}
+
+inline uint32_t divide1000000(uint32_t v) {
+    return uint32_t((uint64_t(v) * 0x431BDE83u) >> 50);
+}
+
+inline bool acceptedByDigitTables(uint32_t value, const DigitTables& tables) {
+    if (value >= 1000000000) return false;
+    uint32_t high = divide1000000(value);
+    uint32_t rest = value - high * 1000000;
+    uint32_t middle = divide1000(rest);
+    uint32_t a = tables.chunks[0][high];
+    uint32_t b = tables.chunks[1][middle];
+    uint32_t c = tables.chunks[2][rest - middle * 1000];
+    uint32_t all = a | b | c;
+    return ((a & b) | (a & c) | (b & c) | (all & CHUNK_INVALID)) == 0 && (all & tables.required) == tables.required;
+}
+
+//--------------------------------------------------------------------
+// Kernels: divisibility, digit-table validation and conflict scans
+//--------------------------------------------------------------------
+// Each kernel has a portable scalar version plus AVX2 and AVX-512 versions compiled with
+// per-function target attributes, so one binary runs on any x86-64 machine and the best
+// set is picked once at startup (see selectKernels).
+
+struct KernelSet {
+    const char* name;
+    // Writes the indices of the values divisible by divisor to outIndices; returns their count.
+    size_t (*filterDivisible)(const uint32_t* values, size_t count, uint32_t divisor, uint32_t* outIndices);
+    // Writes the indices of the values that are valid rows under tables; none of 10^9 or more is.
+    size_t (*filterDigitTables)(const uint32_t* values, size_t count, const DigitTables& tables, uint32_t* outIndices);
+    // Returns the first index in [begin, end) whose bits don't intersect used, or end if none.
+    size_t (*findCompatible)(const CandidateBits* candidates, size_t begin, size_t end, CandidateBits used);
+};
+
+size_t filterDivisibleScalar(const uint32_t* values, size_t count, uint32_t divisor, uint32_t* outIndices) {
+    DivisibilityTest test = makeDivisibilityTest(divisor);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (isDivisible(values[i], test)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+size_t filterDigitTablesScalar(const uint32_t* values, size_t count, const DigitTables& tables, uint32_t* outIndices) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (acceptedByDigitTables(values[i], tables)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+size_t findCompatibleScalar(const CandidateBits* candidates, size_t begin, size_t end, CandidateBits used) {
+    for (size_t i = begin; i < end; i++) {
+        if (((candidates[i].lo & used.lo) | (candidates[i].hi & used.hi)) == 0) {
+            return i;
+        }
+    }
+    return end;
+}
+
+#ifdef SUDOKU_X86_KERNELS
+
+__attribute__((target("avx2")))
+size_t filterDivisibleAVX2(const uint32_t* values, size_t count, uint32_t divisor, uint32_t* outIndices) {
+    DivisibilityTest test = makeDivisibilityTest(divisor);
+    const __m256i inverse = _mm256_set1_epi32(int(test.inverse));
+    const __m256i limit = _mm256_set1_epi32(int(test.limit));
+    // Shift counts of 32 produce zero, so shift == 0 needs no special case.
+    const __m128i rightShift = _mm_cvtsi32_si128(int(test.shift));
+    const __m128i leftShift = _mm_cvtsi32_si128(int(32 - test.shift));
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(values + i)), inverse);
+        x = _mm256_or_si256(_mm256_srl_epi32(x, rightShift), _mm256_sll_epi32(x, leftShift));
+        // Unsigned x <= limit  <=>  min(x, limit) == x
+        __m256i le = _mm256_cmpeq_epi32(_mm256_min_epu32(x, limit), x);
+        unsigned mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(le)));
+        while (mask) {
+            outIndices[kept++] = uint32_t(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < count; i++) {
+        if (isDivisible(values[i], test)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+__attribute__((target("avx2")))
+size_t filterDigitTablesAVX2(const uint32_t* values, size_t count, const DigitTables& tables, uint32_t* outIndices) {
+    const __m256i magic1000 = _mm256_set1_epi64x(0x10624DD3);
+    const __m256i magic1000000 = _mm256_set1_epi64x(0x431BDE83);
+    const __m256i thousand = _mm256_set1_epi32(1000);
+    const __m256i million = _mm256_set1_epi32(1000000);
+    const __m256i invalid = _mm256_set1_epi32(int(CHUNK_INVALID));
+    const __m256i required = _mm256_set1_epi32(int(tables.required));
+    const __m256i largest = _mm256_set1_epi32(999999999);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+        // Lanes of 10^9 and up would index past the tables; they gather nothing and are rejected.
+        __m256i inRange = _mm256_cmpeq_epi32(_mm256_min_epu32(v, largest), v);
+        // _mm256_mul_epu32 multiplies the even lanes; the odd ones go through a second multiply.
+        __m256i high = _mm256_or_si256(_mm256_srli_epi64(_mm256_mul_epu32(v, magic1000000), 50),
+            _mm256_slli_epi64(_mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(v, 32), magic1000000), 50), 32));
+        __m256i rest = _mm256_sub_epi32(v, _mm256_mullo_epi32(high, million));
+        __m256i middle = _mm256_or_si256(_mm256_srli_epi64(_mm256_mul_epu32(rest, magic1000), 38),
+            _mm256_slli_epi64(_mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(rest, 32), magic1000), 38), 32));
+        __m256i low = _mm256_sub_epi32(rest, _mm256_mullo_epi32(middle, thousand));
+        __m256i a = _mm256_mask_i32gather_epi32(zero, (const int*)tables.chunks[0], high, inRange, 4);
+        __m256i b = _mm256_mask_i32gather_epi32(zero, (const int*)tables.chunks[1], middle, inRange, 4);
+        __m256i c = _mm256_mask_i32gather_epi32(zero, (const int*)tables.chunks[2], low, inRange, 4);
+        __m256i all = _mm256_or_si256(_mm256_or_si256(a, b), c);
+        __m256i bad = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                      _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(all, invalid)));
+        __m256i ok = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi32(bad, zero), inRange),
+                                      _mm256_cmpeq_epi32(_mm256_and_si256(all, required), required));
+        unsigned mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(ok)));
+        while (mask) {
+            outIndices[kept++] = uint32_t(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < count; i++) {
+        if (acceptedByDigitTables(values[i], tables)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+__attribute__((target("avx2")))
+size_t findCompatibleAVX2(const CandidateBits* candidates, size_t begin, size_t end, CandidateBits used) {
+    const __m256i usedPair = _mm256_set_epi64x(int64_t(used.hi), int64_t(used.lo), int64_t(used.hi), int64_t(used.lo));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        // Two candidates per register; a lane compares equal to zero when that half doesn't conflict.
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(candidates + i)), usedPair);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(candidates + i + 2)), usedPair);
+        unsigned zeroLanes = unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, zero))))
+                           | (unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(b, zero)))) << 4);
+        unsigned compatible = zeroLanes & (zeroLanes >> 1) & 0x55;
+        if (compatible) {
+            return i + __builtin_ctz(compatible) / 2;
+        }
+    }
+    return findCompatibleScalar(candidates, i, end, used);
+}
+
+__attribute__((target("avx512f")))
+size_t filterDivisibleAVX512(const uint32_t* values, size_t count, uint32_t divisor, uint32_t* outIndices) {
+    DivisibilityTest test = makeDivisibilityTest(divisor);
+    const __m512i inverse = _mm512_set1_epi32(int(test.inverse));
+    const __m512i limit = _mm512_set1_epi32(int(test.limit));
+    const __m512i shift = _mm512_set1_epi32(int(test.shift));
+    // All lanes through the maskz rotate, for the reason given in filterDigitTablesAVX512.
+    const __mmask16 every = 0xFFFF;
+    const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_mullo_epi32(_mm512_loadu_si512(values + i), inverse);
+        x = _mm512_maskz_rorv_epi32(every, x, shift);
+        __mmask16 mask = _mm512_cmple_epu32_mask(x, limit);
+        __m512i index = _mm512_add_epi32(_mm512_set1_epi32(int(i)), lane);
+        _mm512_mask_compressstoreu_epi32(outIndices + kept, mask, index);
+        kept += __builtin_popcount(mask);
+    }
+    for (; i < count; i++) {
+        if (isDivisible(values[i], test)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+__attribute__((target("avx512f")))
+size_t filterDigitTablesAVX512(const uint32_t* values, size_t count, const DigitTables& tables, uint32_t* outIndices) {
+    const __m512i magic1000 = _mm512_set1_epi64(0x10624DD3);
+    const __m512i magic1000000 = _mm512_set1_epi64(0x431BDE83);
+    const __m512i thousand = _mm512_set1_epi32(1000);
+    const __m512i million = _mm512_set1_epi32(1000000);
+    const __m512i billion = _mm512_set1_epi32(1000000000);
+    const __m512i invalid = _mm512_set1_epi32(int(CHUNK_INVALID));
+    const __m512i required = _mm512_set1_epi32(int(tables.required));
+    const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i zero = _mm512_setzero_si512();
+    // The maskz forms take an explicit zero source; the plain ones start from an undefined
+    // register, which gcc reports as maybe-uninitialized.
+    const __mmask8 every = 0xFF;
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i v = _mm512_loadu_si512(values + i);
+        // Lanes of 10^9 and up would index past the tables; they gather nothing and are rejected.
+        __mmask16 inRange = _mm512_cmplt_epu32_mask(v, billion);
+        __m512i high = _mm512_or_si512(_mm512_maskz_srli_epi64(every, _mm512_maskz_mul_epu32(every, v, magic1000000), 50),
+            _mm512_maskz_slli_epi64(every, _mm512_maskz_srli_epi64(every,
+                _mm512_maskz_mul_epu32(every, _mm512_maskz_srli_epi64(every, v, 32), magic1000000), 50), 32));
+        __m512i rest = _mm512_sub_epi32(v, _mm512_mullo_epi32(high, million));
+        __m512i middle = _mm512_or_si512(_mm512_maskz_srli_epi64(every, _mm512_maskz_mul_epu32(every, rest, magic1000), 38),
+            _mm512_maskz_slli_epi64(every, _mm512_maskz_srli_epi64(every,
+                _mm512_maskz_mul_epu32(every, _mm512_maskz_srli_epi64(every, rest, 32), magic1000), 38), 32));
+        __m512i low = _mm512_sub_epi32(rest, _mm512_mullo_epi32(middle, thousand));
+        __m512i a = _mm512_mask_i32gather_epi32(zero, inRange, high, tables.chunks[0], 4);
+        __m512i b = _mm512_mask_i32gather_epi32(zero, inRange, middle, tables.chunks[1], 4);
+        __m512i c = _mm512_mask_i32gather_epi32(zero, inRange, low, tables.chunks[2], 4);
+        __m512i all = _mm512_or_si512(_mm512_or_si512(a, b), c);
+        __m512i bad = _mm512_or_si512(_mm512_or_si512(_mm512_and_si512(a, b), _mm512_and_si512(a, c)),
+                                      _mm512_or_si512(_mm512_and_si512(b, c), _mm512_and_si512(all, invalid)));
+        __mmask16 mask = inRange & _mm512_testn_epi32_mask(bad, bad) &
+                         _mm512_cmpeq_epi32_mask(_mm512_and_si512(all, required), required);
+        __m512i index = _mm512_add_epi32(_mm512_set1_epi32(int(i)), lane);
+        _mm512_mask_compressstoreu_epi32(outIndices + kept, mask, index);
+        kept += __builtin_popcount(mask);
+    }
+    for (; i < count; i++) {
+        if (acceptedByDigitTables(values[i], tables)) {
+            outIndices[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+__attribute__((target("avx512f")))
+size_t findCompatibleAVX512(const CandidateBits* candidates, size_t begin, size_t end, CandidateBits used) {
+    const __m512i usedPairs = _mm512_set_epi64(int64_t(used.hi), int64_t(used.lo), int64_t(used.hi), int64_t(used.lo),
+                                               int64_t(used.hi), int64_t(used.lo), int64_t(used.hi), int64_t(used.lo));
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        // Four candidates per register; a set mask bit means that half of the candidate conflicts.
+        unsigned conflicts = unsigned(_mm512_test_epi64_mask(_mm512_loadu_si512(candidates + i), usedPairs))
+                           | (unsigned(_mm512_test_epi64_mask(_mm512_loadu_si512(candidates + i + 4), usedPairs)) << 8);
+        unsigned compatible = ~(conflicts | (conflicts >> 1)) & 0x5555;
+        if (compatible) {
+            return i + __builtin_ctz(compatible) / 2;
+        }
+    }
+    return findCompatibleScalar(candidates, i, end, used);
+}
+
+#endif // SUDOKU_X86_KERNELS
+
+const KernelSet SCALAR_KERNELS = {"scalar", filterDivisibleScalar, filterDigitTablesScalar, findCompatibleScalar};
+#ifdef SUDOKU_X86_KERNELS
+const KernelSet AVX2_KERNELS = {"avx2", filterDivisibleAVX2, filterDigitTablesAVX2, findCompatibleAVX2};
+const KernelSet AVX512_KERNELS = {"avx512", filterDivisibleAVX512, filterDigitTablesAVX512, findCompatibleAVX512};
+#endif
+
+// Kernel sets this CPU can run, best first.
+vector<const KernelSet*> supportedKernelSets() {
+    vector<const KernelSet*> supported;
+#ifdef SUDOKU_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        supported.push_back(&AVX512_KERNELS);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        supported.push_back(&AVX2_KERNELS);
+    }
+#endif
+    supported.push_back(&SCALAR_KERNELS);
+    return supported;
+}
+
+// Resolve the kernel set once per engine. "auto" picks the best supported set; any other
+// name forces that set (for testing and benchmarking) if the CPU can run it. The choice
+// is described in report.
+const KernelSet& selectKernels(const string& requested, string& report) {
+    vector<const KernelSet*> supported = supportedKernelSets();
+    string available;
+    for (const KernelSet* k : supported) {
+        available += string(available.empty() ? "" : ", ") + k->name;
+    }
+    report.clear();
+    if (requested != "auto") {
+        for (const KernelSet* k : supported) {
+            if (requested == k->name) {
+                report = string("Kernel set: ") + k->name + " (forced; supported: " + available + ")";
+                return *k;
+            }
+        }
+        report = "Kernel set '" + requested + "' is not supported on this CPU; falling back to automatic selection.\n";
+    }
+    report += string("Kernel set: ") + supported.front()->name + " (auto-detected; supported: " + available + ")";
+    return *supported.front();
+}
+
+//--------------------------------------------------------------------
+// Per-GCD instance
+//--------------------------------------------------------------------
+
+// The candidates of every row that survive the divisibility filter for one candidate GCD.
+struct GcdInstance {
+    int gcd = 0;
+    vector<vector<vector<int>>> candidates;        // digits of each candidate, per row
+    vector<vector<CandidateBits>> candidateBits;   // conflict bits, parallel to candidates
+    vector<vector<uint32_t>> baseIndex;            // position in the base row list (generation order)
+    vector<vector<uint32_t>> values;               // row value of each candidate
+    vector<vector<long long>> valueScores;         // value-ordering score per candidate (empty if unordered)
+    vector<array<int, 9>> rowSymmetries;           // non-identity row permutations to break (see below)
+};
+
+// The instance made of each row's first counts[r] base candidates listed in indices[r].
+GcdInstance buildInstance(int gcd, const array<vector<uint32_t>, 9>& rowValues,
+                          const array<vector<uint32_t>, 9>& indices, const array<size_t, 9>& counts) {
+    GcdInstance instance;
+    instance.gcd = gcd;
+    instance.candidates.resize(9);
+    instance.candidateBits.resize(9);
+    instance.baseIndex.resize(9);
+    instance.values.resize(9);
+    for (int r = 0; r < 9; r++) {
+        for (size_t i = 0; i < counts[r]; i++) {
+            uint32_t value = rowValues[r][indices[r][i]];
+            string s = numberDigits(value);
+            vector<int> cand;
+            for (char c : s) {
+                cand.push_back(c - '0');
+            }
+            instance.candidates[r].push_back(cand);
+            instance.candidateBits[r].push_back(makeCandidateBits(s));
+            instance.baseIndex[r].push_back(indices[r][i]);
+            instance.values[r].push_back(value);
+        }
+    }
+    return instance;
+}
+
+// buildInstance on the candidates, among each row's first counts[r] in indices[r], that leave
+// out missing. Rows without one stay empty.
+GcdInstance buildMissingDigitInstance(int gcd, int missing, const array<vector<uint32_t>, 9>& rowValues,
+                                      const array<vector<uint32_t>, 9>& indices, const array<size_t, 9>& counts) {
+    array<vector<uint32_t>, 9> kept;
+    array<size_t, 9> keptCounts;
+    for (int r = 0; r < 9; r++) {
+        for (size_t i = 0; i < counts[r]; i++) {
+            if (missingDigit(rowValues[r][indices[r][i]]) == missing) {
+                kept[r].push_back(indices[r][i]);
+            }
+        }
+        keptCounts[r] = kept[r].size();
+    }
+    return buildInstance(gcd, rowValues, kept, keptCounts);
+}
+
+//--------------------------------------------------------------------
+// Row symmetries
+//--------------------------------------------------------------------
+
+// Row permutations that keep Sudoku validity: rows move within their band and bands move as
+// a whole, so perm[3b + i] = 3 * bands[b] + rows[b][i]. A permuted solution is a solution
+// again when every row r can take the candidates of row perm[r]; sameRow(r, s) says so.
+// Returns every such permutation except the identity (a subgroup, closed under composition).
+vector<array<int, 9>> invariantRowPermutations(const function<bool(int, int)>& sameRow) {
+    array<array<bool, 9>, 9> same;
+    for (int r = 0; r < 9; r++) {
+        for (int s = 0; s < 9; s++) {
+            same[r][s] = r == s || sameRow(r, s);
+        }
+    }
+    vector<array<int, 3>> orders;
+    array<int, 3> order = {0, 1, 2};
+    do {
+        orders.push_back(order);
+    } while (next_permutation(order.begin(), order.end()));
+    
+    vector<array<int, 9>> symmetries;
+    for (const array<int, 3>& bands : orders) {
+        for (const array<int, 3>& rows0 : orders) {
+            for (const array<int, 3>& rows1 : orders) {
+                for (const array<int, 3>& rows2 : orders) {
+                    const array<int, 3>* rows[3] = {&rows0, &rows1, &rows2};
+                    array<int, 9> perm;
+                    bool invariant = true;
+                    bool identity = true;
+                    for (int r = 0; r < 9 && invariant; r++) {
+                        perm[r] = 3 * bands[r / 3] + (*rows[r / 3])[r % 3];
+                        invariant = same[r][perm[r]];
+                        identity = identity && perm[r] == r;
+                    }
+                    if (invariant && !identity) {
+                        symmetries.push_back(perm);
+                    }
+                }
+            }
+        }
+    }
+    return symmetries;
+}
+
+vector<array<int, 9>> rowSymmetries(const PuzzleDefinition& puzzle) {
+    return invariantRowPermutations([&](int r, int s) { return puzzle.rowMasks[r] == puzzle.rowMasks[s]; });
+}
+
+// Symmetries of one GCD instance: rows are interchangeable when their candidate lists are equal.
+// Call before value ordering, while every row is still in generation order.
+vector<array<int, 9>> instanceRowSymmetries(const GcdInstance& instance) {
+    return invariantRowPermutations([&](int r, int s) { return instance.values[r] == instance.values[s]; });
+}
+
+// Every grid of the solutions' orbits under the symmetries: grid[perm[r]] placed in row r.
+vector<vector<vector<int>>> expandSymmetricSolutions(const vector<vector<vector<int>>>& solutions,
+                                                     const vector<array<int, 9>>& symmetries) {
+    set<vector<vector<int>>> seen(solutions.begin(), solutions.end());
+    vector<vector<vector<int>>> expanded = solutions;
+    for (const vector<vector<int>>& grid : solutions) {
+        for (const array<int, 9>& perm : symmetries) {
+            vector<vector<int>> image(9);
+            for (int r = 0; r < 9; r++) {
+                image[r] = grid[perm[r]];
+            }
+            if (seen.insert(image).second) {
+                expanded.push_back(move(image));
+            }
+        }
+    }
+    return expanded;
+}
+
+//--------------------------------------------------------------------
+// Value ordering
+//--------------------------------------------------------------------
+
+// Least-constraining-value ordering for one GCD instance. From column-digit and box-digit
+// frequency tables we count, for every candidate, how many candidates of the other rows
+// share a column (rows of other bands) or a box (rows of the same band) with one of its
+// digits, and try the candidates that rule out the fewest first. Ties keep generation order.
+void orderLeastConstraining(GcdInstance& instance) {
+    vector<vector<vector<int>>>& candidates = instance.candidates;
+    vector<vector<CandidateBits>>& candidateBits = instance.candidateBits;
+    
+    // colFreq[r][c][d]: candidates of row r with digit d in column c.
+    // boxFreq[r][k][d]: candidates of row r with digit d in box k of the band.
+    vector<array<array<long long, 10>, 9>> colFreq(9);
+    vector<array<array<long long, 10>, 3>> boxFreq(9);
+    for (int r = 0; r < 9; r++) {
+        for (auto& counts : colFreq[r]) counts.fill(0);
+        for (auto& counts : boxFreq[r]) counts.fill(0);
+        for (const vector<int>& cand : candidates[r]) {
+            for (int c = 0; c < 9; c++) {
+                colFreq[r][c][cand[c]]++;
+                boxFreq[r][c / 3][cand[c]]++;
+            }
+        }
+    }
+    
+    instance.valueScores.assign(9, vector<long long>());
+    for (int r = 0; r < 9; r++) {
+        // weight[c][d]: other-row candidates ruled out by placing digit d in column c of row r.
+        array<array<long long, 10>, 9> weight;
+        for (int c = 0; c < 9; c++) {
+            for (int d = 0; d < 10; d++) {
+                long long w = 0;
+                for (int other = 0; other < 9; other++) {
+                    if (other == r) continue;
+                    w += (other / 3 == r / 3) ? boxFreq[other][c / 3][d] : colFreq[other][c][d];
+                }
+                weight[c][d] = w;
+            }
+        }
+        
+        size_t n = candidates[r].size();
+        vector<pair<long long, size_t>> scored(n);
+        for (size_t i = 0; i < n; i++) {
+            long long score = 0;
+            for (int c = 0; c < 9; c++) {
+                score += weight[c][candidates[r][i][c]];
+            }
+            scored[i] = {score, i};
+        }
+        stable_sort(scored.begin(), scored.end(),
+                    [](const pair<long long, size_t>& a, const pair<long long, size_t>& b) { return a.first < b.first; });
+        
+        vector<vector<int>> orderedCandidates(n);
+        vector<CandidateBits> orderedBits(n);
+        vector<uint32_t> orderedBaseIndex(n);
+        vector<uint32_t> orderedValues(n);
+        instance.valueScores[r].resize(n);
+        for (size_t i = 0; i < n; i++) {
+            orderedCandidates[i] = move(candidates[r][scored[i].second]);
+            orderedBits[i] = candidateBits[r][scored[i].second];
+            orderedBaseIndex[i] = instance.baseIndex[r][scored[i].second];
+            orderedValues[i] = instance.values[r][scored[i].second];
+            instance.valueScores[r][i] = scored[i].first;
+        }
+        candidates[r] = move(orderedCandidates);
+        candidateBits[r] = move(orderedBits);
+        instance.baseIndex[r] = move(orderedBaseIndex);
+        instance.values[r] = move(orderedValues);
+    }
+}
+
+//--------------------------------------------------------------------
+// Sampling profiler
+//--------------------------------------------------------------------
+// Each thread keeps a tag of the phase it is in and, inside RowSolver, the number of rows
+// placed. The SIGPROF handler only reads the interrupted thread's tag and bumps a counter,
+// which keeps it async-signal-safe and cheap.
+
+enum ProfilePhase { PHASE_OTHER, PHASE_GENERATION, PHASE_ROW_FILTER, PHASE_DIVISIBILITY, PHASE_CONVERSION,
+                    PHASE_ORDERING, PHASE_SEARCH, PHASE_SAT, PHASE_CLIQUE, PHASE_DIGITS, PHASE_COUNT };
+const char* const PROFILE_PHASE_NAMES[PHASE_COUNT] = {
+    "other", "generation", "row-filter", "divisibility", "conversion", "ordering", "search", "sat", "clique", "digits"
+};
+
+struct ProfileTag {
+    volatile int phase;
+    volatile int depth;                     // rows placed by RowSolver, -1 outside it
+};
+
+#if defined(__GNUC__)
+static thread_local ProfileTag profileTag __attribute__((tls_model("initial-exec"))) = {PHASE_OTHER, -1};
+#else
+static thread_local ProfileTag profileTag = {PHASE_OTHER, -1};
+#endif
+
+// Depth -1 has the last slot.
+atomic<unsigned long long> profileSamples[PHASE_COUNT][10];
+atomic<bool> profilerRunning{false};
+
+// Tags the calling thread with a phase until destroyed (or set to another one).
+class PhaseScope {
+public:
+    explicit PhaseScope(ProfilePhase phase) : saved(profileTag.phase), savedDepth(profileTag.depth) {
+        set(phase);
+    }
+    
+    ~PhaseScope() {
+        profileTag.phase = saved;
+        profileTag.depth = savedDepth;
+    }
+    
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+    
+    void set(ProfilePhase phase) {
+        profileTag.phase = phase;
+        profileTag.depth = -1;
+    }
+    
+private:
+    int saved;
+    int savedDepth;
+};
+
+#if defined(__unix__)
+void profileSignal(int) {
+    int phase = profileTag.phase;
+    int depth = profileTag.depth;
+    if (phase < 0 || phase >= PHASE_COUNT) phase = PHASE_OTHER;
+    if (depth < 0 || depth > 8) depth = 9;
+    profileSamples[phase][depth].fetch_add(1, memory_order_relaxed);
+}
+#endif
+
+bool startProfiler(unsigned intervalMicros) {
+#if defined(__unix__)
+    if (intervalMicros == 0 || profilerRunning.exchange(true)) return false;
+    for (auto& phase : profileSamples) {
+        for (auto& count : phase) count.store(0, memory_order_relaxed);
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = profileSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = intervalMicros / 1000000;
+    timer.it_interval.tv_usec = intervalMicros % 1000000;
+    timer.it_value = timer.it_interval;
+    if (sigaction(SIGPROF, &action, nullptr) != 0 || setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        profilerRunning = false;
+        return false;
+    }
+    return true;
+#else
+    (void)intervalMicros;
+    return false;
+#endif
+}
+
+void stopProfiler() {
+#if defined(__unix__)
+    if (!profilerRunning.exchange(false)) return;
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    // Ignore rather than restore the default, which would end the process on a pending signal.
+    signal(SIGPROF, SIG_IGN);
+#endif
+}
+
+bool writeProfile(const string& path) {
+    ofstream out(path);
+    if (!out) return false;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        for (int depth = 0; depth < 10; depth++) {
+            unsigned long long count = profileSamples[phase][depth].load(memory_order_relaxed);
+            if (count == 0) continue;
+            out << "sudoku;" << PROFILE_PHASE_NAMES[phase];
+            if (depth < 9) {
+                for (int d = 0; d <= depth; d++) out << ";depth" << d;
+            }
+            out << " " << count << "\n";
+        }
+    }
+    return bool(out);
+}
+
+//--------------------------------------------------------------------
+// Backtracking search
+//--------------------------------------------------------------------
+
+// The solve interface shared by the per-GCD engines: configure, run(), then read the results.
+class InstanceSolver {
+public:
+    virtual ~InstanceSolver() = default;
+    
+    bool firstSolution = false;             // stop at the first solution
+    const atomic<bool>* stop = nullptr;     // lets another thread abandon the search
+    SearchProgress* progress = nullptr;     // optional live counters
+    
+    vector<vector<vector<int>>> solutions;
+    unsigned long long candidateTries = 0;  // engine-specific unit of work (row candidates, decisions, ...)
+    bool exhausted = false;                 // the whole search space was covered
+    
+    virtual void run() = 0;
+};
+
+// Recursive backtracking that places one whole row candidate at a time. Rows are taken in
+// rowOrder, or (dynamicRowOrder) the unplaced row with the fewest compatible candidates is
+// branched on next. forwardChecking prunes as soon as some unplaced row has no candidate left.
+// With instance.rowSymmetries, only the lexicographically smallest grid (by row values, top
+// row first) of every symmetric orbit is searched.
+class RowSolver : public InstanceSolver {
+public:
+    RowSolver(const GcdInstance& instance, const KernelSet& kernels, const vector<int>& rowOrder)
+        : instance(instance), kernels(kernels), rowOrder(rowOrder), solution(9, vector<int>(9, 0)) {
+        for (int r = 0; r < 9; r++) {
+            rowBits[r] = &instance.candidateBits[r];
+            rowOrderIndex[r] = nullptr;
+        }
+    }
+    
+    bool dynamicRowOrder = false;           // branch on the most constrained row instead of rowOrder
+    bool forwardChecking = false;           // prune when an unplaced row has no compatible candidate
+    unsigned long long nodeLimit = 0;       // give up after this many candidate tries; 0 means never
+    
+    // Search row r's candidates in the given order (indices into the instance) instead of
+    // instance order. The order vector must outlive the solver.
+    void setValueOrder(int r, const vector<uint32_t>& order) {
+        orderedBits[r].resize(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            orderedBits[r][i] = instance.candidateBits[r][order[i]];
+        }
+        rowBits[r] = &orderedBits[r];
+        rowOrderIndex[r] = &order;
+    }
+    
+    void run() override {
+        PhaseScope phase(PHASE_SEARCH);
+        colUsed = {0, 0};
+        bandBoxUsed = {0, 0, 0};
+        placed.fill(false);
+        aborted = false;
+        solveFixed(0);
+        flushProgress();
+        exhausted = !aborted && !(firstSolution && !solutions.empty());
+    }
+    
+private:
+    const GcdInstance& instance;
+    const KernelSet& kernels;
+    vector<int> rowOrder;
+    array<const vector<CandidateBits>*, 9> rowBits;
+    array<const vector<uint32_t>*, 9> rowOrderIndex;
+    array<vector<CandidateBits>, 9> orderedBits;
+    
+    // Constraint bits and solution grid. Column bits are shared by all rows; box bits
+    // (in the high word) only by the rows of the same band.
+    CandidateBits colUsed = {0, 0};
+    array<uint64_t, 3> bandBoxUsed = {0, 0, 0};
+    vector<vector<int>> solution;
+    array<uint32_t, 9> placedValue;
+    array<bool, 9> placed;
+    bool aborted = false;
+    unsigned long long reportedTries = 0;
+    
+    CandidateBits usedBitsFor(int r) const {
+        return {colUsed.lo, colUsed.hi | bandBoxUsed[r / 3]};
+    }
+    
+    // Number of row r's candidates compatible with the rows placed so far, counting no further than limit.
+    size_t countCompatible(int r, size_t limit) const {
+        const vector<CandidateBits>& bits = *rowBits[r];
+        CandidateBits used = usedBitsFor(r);
+        size_t count = 0;
+        size_t i = 0;
+        while (count < limit) {
+            i = kernels.findCompatible(bits.data(), i, bits.size(), used);
+            if (i == bits.size()) break;
+            count++;
+            i++;
+        }
+        return count;
+    }
+    
+    // The unplaced row with the fewest compatible candidates, or -1 if one of them has none.
+    int chooseRow() const {
+        int best = -1;
+        size_t bestCount = SIZE_MAX;
+        for (int r : rowOrder) {
+            if (placed[r]) continue;
+            size_t count = countCompatible(r, bestCount);
+            if (count == 0) return -1;
+            if (count < bestCount) {
+                best = r;
+                bestCount = count;
+            }
+        }
+        return best;
+    }
+    
+    // Lex-leader test: the grid must not exceed its image under any symmetry. Compares rows
+    // top-down until the first one that differs from its image or isn't placed yet.
+    bool breaksSymmetry() const {
+        for (const array<int, 9>& perm : instance.rowSymmetries) {
+            for (int r = 0; r < 9; r++) {
+                int s = perm[r];
+                if (s == r) continue;
+                if (!placed[r] || !placed[s] || placedValue[r] < placedValue[s]) break;
+                if (placedValue[r] > placedValue[s]) return true;
+            }
+        }
+        return false;
+    }
+    
+    bool unplacedRowsViable() const {
+        for (int r = 0; r < 9; r++) {
+            if (!placed[r] && countCompatible(r, 1) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void flushProgress() {
+        if (progress) {
+            progress->candidateTries.fetch_add(candidateTries - reportedTries, memory_order_relaxed);
+        }
+        reportedTries = candidateTries;
+    }
+    
+    // Check if at least one of the first columns has a 0
+    bool hasZeroInFirstColumns() const {
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 9; r++) {
+                if (solution[r][c] == 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    bool shouldStop() {
+        if (firstSolution && !solutions.empty()) return true;
+        if (aborted) return true;
+        if ((nodeLimit != 0 && candidateTries >= nodeLimit) || (stop && stop->load(memory_order_relaxed))) {
+            aborted = true;
+        }
+        return aborted;
+    }
+    
+    void solveFixed(int pos) {
+        if (pos == 9) {
+            // Verify we have at least one 0 in the first columns before accepting the solution
+            if (hasZeroInFirstColumns()) {
+                solutions.push_back(solution);
+            }
+            return;
+        }
+        if (shouldStop()) return;
+        
+        profileTag.depth = pos;
+        int r = dynamicRowOrder ? chooseRow() : rowOrder[pos];
+        if (r < 0) return;
+        int band = r / 3;
+        const vector<CandidateBits>& bits = *rowBits[r];
+        CandidateBits used = usedBitsFor(r);
+        placed[r] = true;
+        
+        // Fast conflict scan: jump straight to the next candidate that fits, counting
+        // the skipped ones as tried.
+        size_t i = 0;
+        size_t n = bits.size();
+        while (true) {
+            size_t next = kernels.findCompatible(bits.data(), i, n, used);
+            candidateTries += (next < n ? next + 1 : n) - i;
+            if (candidateTries - reportedTries >= (1 << 16)) flushProgress();
+            if (next == n) break;
+            
+            // Save old bits for backtracking
+            CandidateBits oldColUsed = colUsed;
+            uint64_t oldBandBoxUsed = bandBoxUsed[band];
+            
+            // Update bits and solution
+            colUsed.lo |= bits[next].lo;
+            colUsed.hi |= bits[next].hi & COLUMN_BITS_HI_MASK;
+            bandBoxUsed[band] |= bits[next].hi & ~COLUMN_BITS_HI_MASK;
+            size_t index = rowOrderIndex[r] ? (*rowOrderIndex[r])[next] : next;
+            const vector<int>& cand = instance.candidates[r][index];
+            for (int c = 0; c < 9; c++) {
+                solution[r][c] = cand[c];
+            }
+            placedValue[r] = instance.values[r][index];
+            
+            if ((instance.rowSymmetries.empty() || !breaksSymmetry()) && (!forwardChecking || unplacedRowsViable())) {
+                solveFixed(pos + 1);
+                profileTag.depth = pos;
+            }
+            
+            // Restore bits for backtracking
+            colUsed = oldColUsed;
+            bandBoxUsed[band] = oldBandBoxUsed;
+            i = next + 1;
+            if (shouldStop()) break;
+        }
+        placed[r] = false;
+    }
+};
+
+//--------------------------------------------------------------------
+// Worker telemetry and task pool
+//--------------------------------------------------------------------
+// Every parallel stage reports per-worker busy time, idle time and tasks to a PoolTelemetry;
+// runPool's queues add steal and queue-depth counts. Idle time is the stage's wall time minus
+// the worker's busy time, so it covers waiting for work, round barriers and the last worker.
+
+class PoolTelemetry {
+public:
+    typedef chrono::steady_clock Clock;
+    
+    bool tracing = false;                   // keep each task's span for writeTrace
+    
+    void task(const string& stage, int worker, Clock::time_point start, Clock::time_point end, const string& label) {
+        double seconds = chrono::duration<double>(end - start).count();
+        lock_guard<mutex> guard(lock);
+        WorkerTelemetry& slot = at(stage, worker);
+        slot.tasks++;
+        slot.busySeconds += seconds;
+        stageBusy[{stage, worker}] += seconds;
+        if (tracing) {
+            spans.push_back({stage, worker, micros(start), micros(end), label});
+        }
+    }
+    
+    void steal(const string& stage, int worker, bool succeeded) {
+        lock_guard<mutex> guard(lock);
+        WorkerTelemetry& slot = at(stage, worker);
+        slot.stealAttempts++;
+        slot.steals += succeeded;
+    }
+    
+    void queueDepth(const string& stage, int worker, size_t depth) {
+        lock_guard<mutex> guard(lock);
+        WorkerTelemetry& slot = at(stage, worker);
+        slot.queueSamples++;
+        slot.queueDepthSum += depth;
+        slot.queueDepthMax = max(slot.queueDepthMax, depth);
+    }
+    
+    // Closes one run of a stage that had the given number of workers.
+    void stageFinished(const string& stage, int workers, Clock::time_point start) {
+        double wall = chrono::duration<double>(Clock::now() - start).count();
+        lock_guard<mutex> guard(lock);
+        for (int w = 0; w < workers; w++) {
+            double& busy = stageBusy[{stage, w}];
+            at(stage, w).idleSeconds += max(0.0, wall - busy);
+            busy = 0;
+        }
+    }
+    
+    vector<WorkerTelemetry> snapshot() const {
+        lock_guard<mutex> guard(lock);
+        vector<WorkerTelemetry> workers;
+        for (const auto& entry : slots) {
+            workers.push_back(entry.second);
+        }
+        return workers;
+    }
+    
+    bool writeTrace(const string& path) const {
+        ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        lock_guard<mutex> guard(lock);
+        map<string, int> stageIds;
+        for (const auto& entry : slots) {
+            stageIds.insert({entry.first.first, int(stageIds.size()) + 1});
+        }
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& stage : stageIds) {
+            out << (first ? "" : ",") << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << stage.second
+                << ",\"args\":{\"name\":\"" << stage.first << "\"}}";
+            first = false;
+        }
+        for (const Span& span : spans) {
+            out << ",\n{\"name\":\"" << span.label << "\",\"cat\":\"" << span.stage << "\",\"ph\":\"X\",\"ts\":"
+                << span.start << ",\"dur\":" << span.end - span.start << ",\"pid\":" << stageIds[span.stage]
+                << ",\"tid\":" << span.worker << "}";
+        }
+        out << "\n]}\n";
+        return bool(out);
+    }
+    
+private:
+    struct Span {
+        string stage;
+        int worker;
+        long long start, end;               // microseconds since the telemetry was created
+        string label;
+    };
+    
+    WorkerTelemetry& at(const string& stage, int worker) {
+        WorkerTelemetry& slot = slots[{stage, worker}];
+        slot.stage = stage;
+        slot.worker = worker;
+        return slot;
+    }
+    
+    long long micros(Clock::time_point t) const {
+        return chrono::duration_cast<chrono::microseconds>(t - origin).count();
+    }
+    
+    mutable mutex lock;
+    map<pair<string, int>, WorkerTelemetry> slots;
+    map<pair<string, int>, double> stageBusy;   // busy seconds in the stage's current run
+    vector<Span> spans;
+    Clock::time_point origin = Clock::now();
+};
+
+// Runs tasks 0..count-1 on a fixed number of workers, the caller being worker 0. Tasks are
+// dealt round-robin into per-worker queues; a worker takes from the back of its own queue
+// and, once that is empty, steals from the front of the others'.
+void runPool(const string& stage, int workers, size_t count, const function<void(size_t)>& run,
+             const function<string(size_t)>& label, PoolTelemetry* telemetry) {
+    struct Queue {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+    workers = max(1, workers);
+    vector<Queue> queues(workers);
+    for (size_t i = 0; i < count; i++) {
+        queues[i % workers].tasks.push_back(i);
+    }
+    auto startTime = PoolTelemetry::Clock::now();
+    
+    auto worker = [&](int id) {
+        while (true) {
+            size_t task = 0;
+            bool found = false;
+            {
+                lock_guard<mutex> guard(queues[id].lock);
+                if (!queues[id].tasks.empty()) {
+                    task = queues[id].tasks.back();
+                    queues[id].tasks.pop_back();
+                    found = true;
+                    if (telemetry) telemetry->queueDepth(stage, id, queues[id].tasks.size());
+                }
+            }
+            for (int k = 1; !found && k < workers; k++) {
+                Queue& victim = queues[(id + k) % workers];
+                {
+                    lock_guard<mutex> guard(victim.lock);
+                    if (!victim.tasks.empty()) {
+                        task = victim.tasks.front();
+                        victim.tasks.pop_front();
+                        found = true;
+                    }
+                }
+                if (telemetry) telemetry->steal(stage, id, found);
+            }
+            if (!found) {
+                return;
+            }
+            auto taskStart = PoolTelemetry::Clock::now();
+            run(task);
+            if (telemetry) {
+                telemetry->task(stage, id, taskStart, PoolTelemetry::Clock::now(),
+                                telemetry->tracing ? label(task) : string());
+            }
+        }
+    };
+    
+    vector<thread> threads;
+    for (int id = 1; id < workers; id++) {
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (telemetry) telemetry->stageFinished(stage, workers, startTime);
+}
+
+//--------------------------------------------------------------------
+// NUMA placement
+//--------------------------------------------------------------------
+// With numaReplicate, parallel workers are spread over the NUMA nodes round-robin, pinned to
+// their node's CPUs, and search a copy of the GCD instance whose pages live on that node: a
+// thread pinned to the node makes the copy (first touch), and builds with SUDOKU_USE_LIBNUMA
+// (link -lnuma) also bind the hot conflict-bit arrays with numa_tonode_memory. On single-node
+// machines, or where the topology can't be read, everyone shares the one copy.
+
+struct NumaNode {
+    int id;
+    vector<int> cpus;
+};
+
+// Parses a kernel CPU/node list such as "0-3,8-11".
+vector<int> parseCpuList(const string& text) {
+    vector<int> items;
+    stringstream in(text);
+    string range;
+    while (getline(in, range, ',')) {
+        int first = 0, last = 0;
+        int fields = sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (fields < 1) {
+            continue;
+        }
+        for (int i = first; i <= (fields == 2 ? last : first); i++) {
+            items.push_back(i);
+        }
+    }
+    return items;
+}
+
+// Nodes that have CPUs, in node order.
+vector<NumaNode> detectNumaNodes() {
+    vector<NumaNode> nodes;
+#if defined(SUDOKU_USE_LIBNUMA)
+    if (numa_available() >= 0) {
+        struct bitmask* cpus = numa_allocate_cpumask();
+        for (int n = 0; n <= numa_max_node(); n++) {
+            if (!numa_bitmask_isbitset(numa_all_nodes_ptr, n) || numa_node_to_cpus(n, cpus) != 0) {
+                continue;
+            }
+            NumaNode node{n, {}};
+            for (unsigned c = 0; c < cpus->size; c++) {
+                if (numa_bitmask_isbitset(cpus, c)) {
+                    node.cpus.push_back(int(c));
+                }
+            }
+            if (!node.cpus.empty()) {
+                nodes.push_back(node);
+            }
+        }
+        numa_free_cpumask(cpus);
+    }
+#elif defined(__linux__)
+    ifstream online("/sys/devices/system/node/online");
+    string list;
+    if (getline(online, list)) {
+        for (int n : parseCpuList(list)) {
+            ifstream cpulist("/sys/devices/system/node/node" + to_string(n) + "/cpulist");
+            string cpus;
+            NumaNode node{n, {}};
+            if (getline(cpulist, cpus)) {
+                node.cpus = parseCpuList(cpus);
+            }
+            if (!node.cpus.empty()) {
+                nodes.push_back(node);
+            }
+        }
+    }
+#endif
+    return nodes;
+}
+
+// Pins the calling thread to a node's CPUs for its lifetime and then restores the previous
+// affinity. A null node leaves the thread alone.
+class NodeAffinity {
+public:
+    explicit NodeAffinity(const NumaNode* node) {
+#if defined(__linux__)
+        if (!node || sched_getaffinity(0, sizeof(saved), &saved) != 0) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : node->cpus) {
+            if (c < CPU_SETSIZE) {
+                CPU_SET(c, &set);
+            }
+        }
+        pinned = sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)node;
+#endif
+    }
+    
+    ~NodeAffinity() {
+#if defined(__linux__)
+        if (pinned) {
+            sched_setaffinity(0, sizeof(saved), &saved);
+        }
+#endif
+    }
+    
+    NodeAffinity(const NodeAffinity&) = delete;
+    NodeAffinity& operator=(const NodeAffinity&) = delete;
+    
+private:
+#if defined(__linux__)
+    cpu_set_t saved;
+#endif
+    bool pinned = false;
+};
+
+// Pages of the instance's conflict-bit arrays (what the search scans) and how many of them
+// reside on a node other than the given one. Pages whose node can't be queried aren't counted.
+pair<size_t, size_t> remotePages(const GcdInstance& instance, int node) {
+    size_t pages = 0, remote = 0;
+#if defined(__linux__) && defined(SYS_move_pages)
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (const auto& bits : instance.candidateBits) {
+        if (bits.empty()) {
+            continue;
+        }
+        uintptr_t first = uintptr_t(bits.data()) & ~uintptr_t(pageSize - 1);
+        uintptr_t end = uintptr_t(bits.data() + bits.size());
+        vector<void*> addresses;
+        for (uintptr_t page = first; page < end; page += pageSize) {
+            addresses.push_back(reinterpret_cast<void*>(page));
+        }
+        vector<int> status(addresses.size(), -1);
+        // With no target nodes, move_pages only reports where each page lives.
+        if (syscall(SYS_move_pages, 0, addresses.size(), addresses.data(), nullptr, status.data(), 0) != 0) {
+            continue;
+        }
+        for (int s : status) {
+            if (s >= 0) {
+                pages++;
+                remote += s != node;
+            }
+        }
+    }
+#else
+    (void)instance;
+    (void)node;
+#endif
+    return {pages, remote};
+}
+
+// Per-node copies of a GCD instance for parallel workers. Worker i runs on node i mod nodes;
+// without copies (single node) every worker gets the shared instance and isn't pinned.
+struct InstanceReplicas {
+    vector<NumaNode> nodes;
+    vector<unique_ptr<GcdInstance>> copies;
+    
+    const NumaNode* nodeFor(int worker) const {
+        return copies.empty() ? nullptr : &nodes[worker % nodes.size()];
+    }
+    
+    const GcdInstance& instanceFor(int worker, const GcdInstance& shared) const {
+        return copies.empty() ? shared : *copies[worker % copies.size()];
+    }
+};
+
+InstanceReplicas replicateInstance(const GcdInstance& instance, const vector<NumaNode>& nodes) {
+    InstanceReplicas replicas;
+    replicas.nodes = nodes;
+    if (nodes.size() < 2) {
+        return replicas;
+    }
+    replicas.copies.resize(nodes.size());
+    vector<thread> threads;
+    for (size_t n = 0; n < nodes.size(); n++) {
+        threads.emplace_back([&, n]() {
+            NodeAffinity pin(&nodes[n]);
+            GcdInstance* copy = new GcdInstance(instance);
+#if defined(SUDOKU_USE_LIBNUMA)
+            for (auto& bits : copy->candidateBits) {
+                if (!bits.empty()) {
+                    numa_tonode_memory(bits.data(), bits.size() * sizeof(CandidateBits), nodes[n].id);
+                }
+            }
+#endif
+            replicas.copies[n].reset(copy);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return replicas;
+}
+
+// Share of the table pages each worker reads that sit on another node, averaged over the
+// workers, for the replicas and for the shared copy they replace.
+string numaReport(const InstanceReplicas& replicas, const GcdInstance& shared, int workers) {
+    ostringstream report;
+    if (replicas.copies.empty()) {
+        report << "NUMA: " << (replicas.nodes.empty() ? "topology unavailable" : "single node")
+               << ", one shared copy of the tables.";
+        return report.str();
+    }
+    double replicated = 0, sharedRemote = 0;
+    for (int w = 0; w < workers; w++) {
+        int node = replicas.nodeFor(w)->id;
+        pair<size_t, size_t> own = remotePages(replicas.instanceFor(w, shared), node);
+        pair<size_t, size_t> common = remotePages(shared, node);
+        replicated += own.first ? double(own.second) / own.first : 0;
+        sharedRemote += common.first ? double(common.second) / common.first : 0;
+    }
+    report << fixed << setprecision(1) << "NUMA: " << replicas.nodes.size() << " nodes, " << workers
+           << " worker(s) pinned round-robin; remote table pages per worker "
+           << 100 * replicated / workers << "% with replicas, "
+           << 100 * sharedRemote / workers << "% with one shared copy.";
+    return report.str();
+}
+
+//--------------------------------------------------------------------
+// Randomized restarts for first-solution searches
+//--------------------------------------------------------------------
+
+// Luby et al.'s universal restart sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ... (i counts from 1).
+unsigned long long lubyTerm(unsigned long long i) {
+    while (true) {
+        int k = 1;
+        while ((1ULL << k) - 1 < i) {
+            k++;
+        }
+        if (i == (1ULL << k) - 1) {
+            return 1ULL << (k - 1);
+        }
+        i -= (1ULL << (k - 1)) - 1;
+    }
+}
+
+// Random row order: rows sorted by candidate count, with rows whose counts are within
+// about 10% of each other treated as tied and broken at random.
+vector<int> randomizedRowOrder(const GcdInstance& instance, mt19937_64& rng) {
+    uniform_real_distribution<double> jitter(0.0, log(1.1));
+    vector<pair<double, int>> keyed;
+    for (int r = 0; r < 9; r++) {
+        keyed.push_back({log(double(instance.candidates[r].size())) + jitter(rng), r});
+    }
+    sort(keyed.begin(), keyed.end());
+    vector<int> order;
+    for (const auto& k : keyed) {
+        order.push_back(k.second);
+    }
+    return order;
+}
+
+// Random value order for one row: keep the value-ordering scores, but candidates whose scores
+// fall within 1/32 of the row's score range of each other are tied and shuffled.
+vector<uint32_t> randomizedValueOrder(const GcdInstance& instance, int r, mt19937_64& rng) {
+    size_t n = instance.candidates[r].size();
+    static const vector<long long> noScores;
+    const vector<long long>& scores = instance.valueScores.empty() ? noScores : instance.valueScores[r];
+    long long lowest = 0;
+    long long tieWidth = 1;
+    if (!scores.empty()) {
+        auto range = minmax_element(scores.begin(), scores.end());
+        lowest = *range.first;
+        tieWidth = max(1LL, (*range.second - *range.first) / 32);
+    }
+    vector<pair<pair<long long, uint64_t>, uint32_t>> keyed(n);
+    for (size_t i = 0; i < n; i++) {
+        long long bucket = scores.empty() ? 0 : (scores[i] - lowest) / tieWidth;
+        keyed[i] = {{bucket, rng()}, uint32_t(i)};
+    }
+    sort(keyed.begin(), keyed.end());
+    vector<uint32_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = keyed[i].second;
+    }
+    return order;
+}
+
+struct RestartResult {
+    vector<vector<int>> solution;       // the witness, if found
+    bool found = false;
+    bool exhausted = false;             // a run searched the whole tree without a witness
+    unsigned long long candidateTries = 0;
+    unsigned long long runs = 0;
+    int winningWorker = -1;
+};
+
+// One randomized run of a restart search.
+struct RestartRun {
+    vector<vector<int>> solution;
+    bool found = false;
+    bool exhausted = false;
+    unsigned long long candidateTries = 0;
+};
+
+RestartRun randomizedRun(const GcdInstance& instance, const KernelSet& kernels, mt19937_64& rng,
+                         unsigned long long nodeLimit, const atomic<bool>* stop, SearchProgress* progress) {
+    vector<int> rowOrder = randomizedRowOrder(instance, rng);
+    array<vector<uint32_t>, 9> valueOrder;
+    RowSolver solver(instance, kernels, rowOrder);
+    for (int r = 0; r < 9; r++) {
+        valueOrder[r] = randomizedValueOrder(instance, r, rng);
+        solver.setValueOrder(r, valueOrder[r]);
+    }
+    solver.firstSolution = true;
+    solver.nodeLimit = nodeLimit;
+    solver.stop = stop;
+    solver.progress = progress;
+    solver.run();
+    
+    RestartRun run;
+    run.found = !solver.solutions.empty();
+    run.exhausted = solver.exhausted && !run.found;
+    if (run.found) {
+        run.solution = solver.solutions.front();
+    }
+    run.candidateTries = solver.candidateTries;
+    return run;
+}
+
+mt19937_64 restartWorkerRng(uint64_t seed, int id) {
+    return mt19937_64(seed + 0x9E3779B97F4A7C15ULL * uint64_t(id + 1));
+}
+
+// Deterministic variant: the workers make their runs in lock-step rounds with the same budget,
+// nobody is interrupted mid-run, and the lowest worker id with a witness or proof wins. The
+// result and the counters depend only on the seed, not on thread timing.
+RestartResult solveWithRestartsInRounds(const GcdInstance& instance, const KernelSet& kernels,
+                                        unsigned long long restartUnit, int workers, uint64_t seed,
+                                        SearchProgress* progress, const InstanceReplicas* replicas = nullptr,
+                                        PoolTelemetry* telemetry = nullptr) {
+    auto startTime = PoolTelemetry::Clock::now();
+    RestartResult result;
+    vector<mt19937_64> rngs;
+    for (int id = 0; id < workers; id++) {
+        rngs.push_back(restartWorkerRng(seed, id));
+    }
+    vector<RestartRun> runs(workers);
+    for (unsigned long long round = 1; result.winningWorker < 0; round++) {
+        unsigned long long nodeLimit = lubyTerm(round) * restartUnit;
+        auto run = [&](int id) {
+            NodeAffinity pin(replicas ? replicas->nodeFor(id) : nullptr);
+            const GcdInstance& local = replicas ? replicas->instanceFor(id, instance) : instance;
+            auto runStart = PoolTelemetry::Clock::now();
+            runs[id] = randomizedRun(local, kernels, rngs[id], nodeLimit, nullptr, progress);
+            if (telemetry) {
+                telemetry->task("restarts", id, runStart, PoolTelemetry::Clock::now(),
+                                telemetry->tracing ? "round " + to_string(round) : string());
+            }
+        };
+        vector<thread> threads;
+        for (int id = 1; id < workers; id++) {
+            threads.emplace_back(run, id);
+        }
+        run(0);
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (int id = 0; id < workers; id++) {
+            result.candidateTries += runs[id].candidateTries;
+            result.runs++;
+            if (result.winningWorker < 0 && (runs[id].found || runs[id].exhausted)) {
+                result.found = runs[id].found;
+                result.exhausted = runs[id].exhausted;
+                result.solution = runs[id].solution;
+                result.winningWorker = id;
+            }
+        }
+    }
+    if (telemetry) telemetry->stageFinished("restarts", workers, startTime);
+    return result;
+}
+
+// First-solution search with randomized tie-breaking and a Luby restart schedule: run i gets
+// lubyTerm(i) * restartUnit candidate tries before starting over with a fresh random order.
+// With several workers, each follows its own random sequence and the first witness (or the
+// first exhaustive run, which proves the instance has none) stops the rest. A caller racing
+// other searches can pass its own sharedStop flag: it is raised on finishing, and if someone
+// else raises it first the search returns with neither a witness nor a proof. With replicas,
+// each worker is pinned to its node and searches that node's copy.
+RestartResult solveWithRestarts(const GcdInstance& instance, const KernelSet& kernels,
+                                unsigned long long restartUnit, int workers, uint64_t seed,
+                                SearchProgress* progress, atomic<bool>* sharedStop = nullptr,
+                                const InstanceReplicas* replicas = nullptr, PoolTelemetry* telemetry = nullptr) {
+    auto startTime = PoolTelemetry::Clock::now();
+    RestartResult result;
+    mutex resultMutex;
+    atomic<bool> ownStop{false};
+    atomic<bool>& done = sharedStop ? *sharedStop : ownStop;
+    
+    auto worker = [&](int id) {
+        NodeAffinity pin(replicas ? replicas->nodeFor(id) : nullptr);
+        const GcdInstance& local = replicas ? replicas->instanceFor(id, instance) : instance;
+        mt19937_64 rng = restartWorkerRng(seed, id);
+        unsigned long long tries = 0;
+        unsigned long long runs = 0;
+        while (!done.load()) {
+            runs++;
+            auto runStart = PoolTelemetry::Clock::now();
+            RestartRun run = randomizedRun(local, kernels, rng, lubyTerm(runs) * restartUnit, &done, progress);
+            if (telemetry) {
+                telemetry->task("restarts", id, runStart, PoolTelemetry::Clock::now(),
+                                telemetry->tracing ? "run " + to_string(runs) : string());
+            }
+            tries += run.candidateTries;
+            
+            if (run.found || run.exhausted) {
+                lock_guard<mutex> guard(resultMutex);
+                if (!done.exchange(true)) {
+                    result.found = run.found;
+                    result.exhausted = run.exhausted;
+                    result.solution = run.solution;
+                    result.winningWorker = id;
+                }
+            }
+        }
+        lock_guard<mutex> guard(resultMutex);
+        result.candidateTries += tries;
+        result.runs += runs;
+    };
+    
+    vector<thread> threads;
+    for (int id = 1; id < workers; id++) {
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (telemetry) telemetry->stageFinished("restarts", workers, startTime);
+    return result;
+}
+
+//--------------------------------------------------------------------
+// Minimal CDCL SAT solver
+//--------------------------------------------------------------------
+// Two watched literals, first-UIP clause learning with non-chronological backjumping,
+// VSIDS activities with phase saving, Luby restarts and periodic removal of inactive
+// learnt clauses. Variables are 0-based; literal 2*v is v and 2*v+1 is not-v.
+
+class CdclSolver {
+public:
+    enum Result { SATISFIABLE, UNSATISFIABLE, INTERRUPTED };
+    
+    unsigned long long conflicts = 0;
+    unsigned long long decisions = 0;
+    unsigned long long propagations = 0;
+    
+    int addVariable() {
+        int v = int(assigns.size());
+        assigns.push_back(-1);
+        level.push_back(0);
+        reason.push_back(-1);
+        activity.push_back(0.0);
+        negativePhase.push_back(1);
+        seen.push_back(0);
+        heapIndex.push_back(-1);
+        watches.resize(2 * assigns.size());
+        heapInsert(v);
+        return v;
+    }
+    
+    // Adds a clause at decision level 0. Returns false once the formula is known unsatisfiable.
+    bool addClause(vector<int> lits) {
+        cancelUntil(0);
+        if (!ok) return false;
+        sort(lits.begin(), lits.end());
+        vector<int> kept;
+        for (size_t i = 0; i < lits.size(); i++) {
+            if (i > 0 && lits[i] == lits[i - 1]) continue;
+            if (i > 0 && lits[i] == (lits[i - 1] ^ 1)) return true;  // tautology
+            int value = litValue(lits[i]);
+            if (value == 1) return true;                             // already satisfied
+            if (value == -1) kept.push_back(lits[i]);
+        }
+        if (kept.empty()) {
+            ok = false;
+        } else if (kept.size() == 1) {
+            enqueue(kept[0], -1);
+            ok = propagate() == -1;
+        } else {
+            attachClause(move(kept), false);
+        }
+        return ok;
+    }
+    
+    Result solve(const atomic<bool>* stop) {
+        cancelUntil(0);
+        if (!ok || propagate() != -1) {
+            ok = false;
+            return UNSATISFIABLE;
+        }
+        unsigned long long restart = 1;
+        unsigned long long conflictsThisRestart = 0;
+        vector<int> learnt;
+        while (true) {
+            int confl = propagate();
+            if (confl != -1) {
+                conflicts++;
+                conflictsThisRestart++;
+                if (decisionLevel() == 0) {
+                    ok = false;
+                    return UNSATISFIABLE;
+                }
+                int backtrackLevel;
+                analyze(confl, learnt, backtrackLevel);
+                cancelUntil(backtrackLevel);
+                if (learnt.size() == 1) {
+                    enqueue(learnt[0], -1);
+                } else {
+                    int ci = attachClause(learnt, true);
+                    enqueue(learnt[0], ci);
+                }
+                varIncrement /= 0.95;
+                clauseIncrement /= 0.999;
+            } else {
+                if (conflictsThisRestart >= lubyTerm(restart) * 100) {
+                    cancelUntil(0);
+                    restart++;
+                    conflictsThisRestart = 0;
+                    if (learntCount > maxLearnts) {
+                        reduceLearnts();
+                    }
+                    continue;
+                }
+                if (stop && (decisions & 255) == 0 && stop->load(memory_order_relaxed)) {
+                    cancelUntil(0);
+                    return INTERRUPTED;
+                }
+                int next = pickBranchLiteral();
+                if (next == -1) {
+                    model.assign(assigns.begin(), assigns.end());
+                    return SATISFIABLE;
+                }
+                decisions++;
+                trailLimits.push_back(int(trail.size()));
+                enqueue(next, -1);
+            }
+        }
+    }
+    
+    // Value of variable v in the last model found.
+    bool modelValue(int v) const {
+        return model[v] == 1;
+    }
+    
+    size_t numVariables() const { return assigns.size(); }
+    
+private:
+    struct Clause {
+        vector<int> lits;       // lits[0] and lits[1] are the watched literals
+        bool learnt;
+        double activity;
+    };
+    
+    bool ok = true;
+    vector<Clause> clauses;
+    vector<vector<int>> watches;            // clause indices watching each literal
+    vector<int8_t> assigns;                 // 1 true, 0 false, -1 unassigned
+    vector<int8_t> model;
+    vector<int> level;
+    vector<int> reason;                     // implying clause, or -1 for decisions and units
+    vector<int> trail;
+    vector<int> trailLimits;                // trail size at the start of each decision level
+    size_t propagationHead = 0;
+    vector<double> activity;
+    vector<int8_t> negativePhase;           // saved phase; new variables start false
+    vector<int8_t> seen;
+    vector<int> heap;                       // max-heap of variables by activity
+    vector<int> heapIndex;
+    double varIncrement = 1.0;
+    double clauseIncrement = 1.0;
+    size_t learntCount = 0;
+    size_t maxLearnts = 20000;
+    
+    int decisionLevel() const { return int(trailLimits.size()); }
+    
+    int litValue(int lit) const {
+        int8_t value = assigns[lit >> 1];
+        return value < 0 ? -1 : (value ^ (lit & 1));
+    }
+    
+    void enqueue(int lit, int from) {
+        int v = lit >> 1;
+        assigns[v] = int8_t((lit & 1) ^ 1);
+        level[v] = decisionLevel();
+        reason[v] = from;
+        trail.push_back(lit);
+    }
+    
+    int attachClause(vector<int> lits, bool learnt) {
+        int ci = int(clauses.size());
+        watches[lits[0]].push_back(ci);
+        watches[lits[1]].push_back(ci);
+        clauses.push_back({move(lits), learnt, 0.0});
+        if (learnt) {
+            learntCount++;
+            bumpClause(ci);
+        }
+        return ci;
+    }
+    
+    void cancelUntil(int targetLevel) {
+        if (decisionLevel() <= targetLevel) return;
+        for (int i = int(trail.size()) - 1; i >= trailLimits[targetLevel]; i--) {
+            int v = trail[i] >> 1;
+            negativePhase[v] = assigns[v] == 0;
+            assigns[v] = -1;
+            reason[v] = -1;
+            if (heapIndex[v] < 0) heapInsert(v);
+        }
+        trail.resize(trailLimits[targetLevel]);
+        trailLimits.resize(targetLevel);
+        propagationHead = trail.size();
+    }
+    
+    // Returns the index of a conflicting clause, or -1.
+    int propagate() {
+        while (propagationHead < trail.size()) {
+            int falseLit = trail[propagationHead++] ^ 1;
+            propagations++;
+            vector<int>& ws = watches[falseLit];
+            size_t i = 0, j = 0;
+            while (i < ws.size()) {
+                int ci = ws[i++];
+                vector<int>& lits = clauses[ci].lits;
+                if (lits[0] == falseLit) swap(lits[0], lits[1]);
+                if (litValue(lits[0]) == 1) {
+                    ws[j++] = ci;
+                    continue;
+                }
+                bool moved = false;
+                for (size_t k = 2; k < lits.size(); k++) {
+                    if (litValue(lits[k]) != 0) {
+                        swap(lits[1], lits[k]);
+                        watches[lits[1]].push_back(ci);
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+                ws[j++] = ci;
+                if (litValue(lits[0]) == 0) {
+                    while (i < ws.size()) ws[j++] = ws[i++];
+                    ws.resize(j);
+                    propagationHead = trail.size();
+                    return ci;
+                }
+                enqueue(lits[0], ci);
+            }
+            ws.resize(j);
+        }
+        return -1;
+    }
+    
+    // First-UIP learning. learnt[0] is the asserting literal and learnt[1] (if any) is from backtrackLevel.
+    void analyze(int confl, vector<int>& learnt, int& backtrackLevel) {
+        learnt.assign(1, -1);
+        int pathCount = 0;
+        int p = -1;
+        int index = int(trail.size()) - 1;
+        do {
+            Clause& c = clauses[confl];
+            if (c.learnt) bumpClause(confl);
+            for (size_t k = (p == -1 ? 0 : 1); k < c.lits.size(); k++) {
+                int q = c.lits[k];
+                int v = q >> 1;
+                if (!seen[v] && level[v] > 0) {
+                    bumpVariable(v);
+                    seen[v] = 1;
+                    if (level[v] >= decisionLevel()) {
+                        pathCount++;
+                    } else {
+                        learnt.push_back(q);
+                    }
+                }
+            }
+            while (!seen[trail[index--] >> 1]) {}
+            p = trail[index + 1];
+            confl = reason[p >> 1];
+            seen[p >> 1] = 0;
+            pathCount--;
+        } while (pathCount > 0);
+        learnt[0] = p ^ 1;
+        
+        backtrackLevel = 0;
+        if (learnt.size() > 1) {
+            size_t maxIndex = 1;
+            for (size_t k = 2; k < learnt.size(); k++) {
+                if (level[learnt[k] >> 1] > level[learnt[maxIndex] >> 1]) maxIndex = k;
+            }
+            swap(learnt[1], learnt[maxIndex]);
+            backtrackLevel = level[learnt[1] >> 1];
+        }
+        for (size_t k = 1; k < learnt.size(); k++) {
+            seen[learnt[k] >> 1] = 0;
+        }
+    }
+    
+    int pickBranchLiteral() {
+        while (!heap.empty()) {
+            int v = heapRemoveMax();
+            if (assigns[v] < 0) {
+                return 2 * v + negativePhase[v];
+            }
+        }
+        return -1;
+    }
+    
+    void bumpVariable(int v) {
+        activity[v] += varIncrement;
+        if (activity[v] > 1e100) {
+            for (double& a : activity) a *= 1e-100;
+            varIncrement *= 1e-100;
+        }
+        if (heapIndex[v] >= 0) heapUp(heapIndex[v]);
+    }
+    
+    void bumpClause(int ci) {
+        clauses[ci].activity += clauseIncrement;
+        if (clauses[ci].activity > 1e20) {
+            for (Clause& c : clauses) {
+                if (c.learnt) c.activity *= 1e-20;
+            }
+            clauseIncrement *= 1e-20;
+        }
+    }
+    
+    // Drop the less active half of the learnt clauses longer than two literals. Only called
+    // at level 0, where no reason clause is needed any more; watches are rebuilt from lits[0..1].
+    void reduceLearnts() {
+        vector<double> activities;
+        for (const Clause& c : clauses) {
+            if (c.learnt && c.lits.size() > 2) activities.push_back(c.activity);
+        }
+        if (!activities.empty()) {
+            nth_element(activities.begin(), activities.begin() + activities.size() / 2, activities.end());
+            double median = activities[activities.size() / 2];
+            vector<Clause> keptClauses;
+            learntCount = 0;
+            for (Clause& c : clauses) {
+                if (c.learnt && c.lits.size() > 2 && c.activity < median) continue;
+                if (c.learnt) learntCount++;
+                keptClauses.push_back(move(c));
+            }
+            clauses = move(keptClauses);
+            for (auto& ws : watches) ws.clear();
+            for (size_t ci = 0; ci < clauses.size(); ci++) {
+                watches[clauses[ci].lits[0]].push_back(int(ci));
+                watches[clauses[ci].lits[1]].push_back(int(ci));
+            }
+            for (int lit : trail) reason[lit >> 1] = -1;
+        }
+        maxLearnts += maxLearnts / 10;
+    }
+    
+    void heapInsert(int v) {
+        heapIndex[v] = int(heap.size());
+        heap.push_back(v);
+        heapUp(heapIndex[v]);
+    }
+    
+    int heapRemoveMax() {
+        int top = heap[0];
+        heap[0] = heap.back();
+        heapIndex[heap[0]] = 0;
+        heap.pop_back();
+        heapIndex[top] = -1;
+        if (!heap.empty()) heapDown(0);
+        return top;
+    }
+    
+    void heapUp(int i) {
+        int v = heap[i];
+        while (i > 0 && activity[heap[(i - 1) / 2]] < activity[v]) {
+            heap[i] = heap[(i - 1) / 2];
+            heapIndex[heap[i]] = i;
+            i = (i - 1) / 2;
+        }
+        heap[i] = v;
+        heapIndex[v] = i;
+    }
+    
+    void heapDown(int i) {
+        int v = heap[i];
+        int n = int(heap.size());
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && activity[heap[child + 1]] > activity[heap[child]]) child++;
+            if (activity[heap[child]] <= activity[v]) break;
+            heap[i] = heap[child];
+            heapIndex[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = v;
+        heapIndex[v] = i;
+    }
+};
+
+//--------------------------------------------------------------------
+// SAT encoding of a GCD instance
+//--------------------------------------------------------------------
+
+// CNF for one GCD instance in DIMACS numbering: rowVars[r][i] is true iff row r uses candidate i.
+// Exactly one candidate per row, at most one candidate with digit d per (column, d) and per
+// (box, d), and at least one candidate with a 0 in the first three columns.
+struct InstanceCnf {
+    int numVars = 0;
+    vector<vector<int>> clauses;
+    vector<vector<int>> rowVars;
+};
+
+// At-most-one with Sinz's sequential counter (3n clauses, n-1 auxiliary variables); pairwise for short lists.
+void addAtMostOne(InstanceCnf& cnf, const vector<int>& lits) {
+    size_t n = lits.size();
+    if (n <= 4) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i + 1; j < n; j++) {
+                cnf.clauses.push_back({-lits[i], -lits[j]});
+            }
+        }
+        return;
+    }
+    // s[i] is true if some lits[0..i] is true.
+    int first = cnf.numVars + 1;
+    cnf.numVars += int(n - 1);
+    auto s = [first](size_t i) { return first + int(i); };
+    cnf.clauses.push_back({-lits[0], s(0)});
+    for (size_t i = 1; i + 1 < n; i++) {
+        cnf.clauses.push_back({-lits[i], s(i)});
+        cnf.clauses.push_back({-s(i - 1), s(i)});
+        cnf.clauses.push_back({-lits[i], -s(i - 1)});
+    }
+    cnf.clauses.push_back({-lits[n - 1], -s(n - 2)});
+}
+
+InstanceCnf encodeInstance(const GcdInstance& instance) {
+    InstanceCnf cnf;
+    cnf.rowVars.resize(9);
+    for (int r = 0; r < 9; r++) {
+        for (size_t i = 0; i < instance.candidates[r].size(); i++) {
+            cnf.rowVars[r].push_back(++cnf.numVars);
+        }
+    }
+    
+    vector<vector<int>> columnDigit(90);    // c*10 + d
+    vector<vector<int>> boxDigit(90);       // b*10 + d
+    vector<int> zeroInFirstColumns;
+    for (int r = 0; r < 9; r++) {
+        cnf.clauses.push_back(cnf.rowVars[r]);
+        addAtMostOne(cnf, cnf.rowVars[r]);
+        for (size_t i = 0; i < instance.candidates[r].size(); i++) {
+            const vector<int>& cand = instance.candidates[r][i];
+            int var = cnf.rowVars[r][i];
+            bool zero = false;
+            for (int c = 0; c < 9; c++) {
+                columnDigit[c * 10 + cand[c]].push_back(var);
+                boxDigit[((r / 3) * 3 + c / 3) * 10 + cand[c]].push_back(var);
+                zero = zero || (c < 3 && cand[c] == 0);
+            }
+            if (zero) zeroInFirstColumns.push_back(var);
+        }
+    }
+    for (const vector<int>& vars : columnDigit) addAtMostOne(cnf, vars);
+    for (const vector<int>& vars : boxDigit) addAtMostOne(cnf, vars);
+    cnf.clauses.push_back(zeroInFirstColumns);
+    return cnf;
+}
+
+// Write the CNF in DIMACS format, with comment lines mapping row variables to candidates.
+bool writeDimacs(const InstanceCnf& cnf, const GcdInstance& instance, const string& path) {
+    ofstream out(path);
+    if (!out) return false;
+    out << "c Somewhat Square Sudoku, candidate GCD " << instance.gcd << "\n";
+    for (int r = 0; r < 9; r++) {
+        for (size_t i = 0; i < instance.candidates[r].size(); i++) {
+            out << "c row " << r + 1 << " var " << cnf.rowVars[r][i] << " = ";
+            for (int d : instance.candidates[r][i]) out << d;
+            out << "\n";
+        }
+    }
+    out << "p cnf " << cnf.numVars << " " << cnf.clauses.size() << "\n";
+    for (const vector<int>& clause : cnf.clauses) {
+        for (int lit : clause) out << lit << " ";
+        out << "0\n";
+    }
+    return bool(out);
+}
+
+// The SAT engine behind the common solve interface. All solutions are enumerated by adding
+// a clause that blocks each model's row choices and solving again.
+class SatRowSolver : public InstanceSolver {
+public:
+    explicit SatRowSolver(const GcdInstance& instance) : instance(instance) {}
+    
+    size_t numVariables = 0;
+    size_t numClauses = 0;
+    unsigned long long conflicts = 0;
+    
+    void run() override {
+        PhaseScope phase(PHASE_SAT);
+        InstanceCnf cnf = encodeInstance(instance);
+        numVariables = cnf.numVars;
+        numClauses = cnf.clauses.size();
+        CdclSolver sat;
+        for (int v = 0; v < cnf.numVars; v++) sat.addVariable();
+        bool ok = true;
+        for (const vector<int>& clause : cnf.clauses) {
+            ok = ok && sat.addClause(toLiterals(clause));
+        }
+        
+        exhausted = !ok;
+        while (ok) {
+            CdclSolver::Result result = sat.solve(stop);
+            if (result == CdclSolver::INTERRUPTED) break;
+            if (result == CdclSolver::UNSATISFIABLE) {
+                exhausted = true;
+                break;
+            }
+            vector<vector<int>> grid(9);
+            vector<int> blocking;
+            for (int r = 0; r < 9; r++) {
+                for (size_t i = 0; i < cnf.rowVars[r].size(); i++) {
+                    if (sat.modelValue(cnf.rowVars[r][i] - 1)) {
+                        grid[r] = instance.candidates[r][i];
+                        blocking.push_back(-cnf.rowVars[r][i]);
+                        break;
+                    }
+                }
+            }
+            solutions.push_back(grid);
+            if (firstSolution) break;
+            ok = sat.addClause(toLiterals(blocking));
+            if (!ok) exhausted = true;
+        }
+        candidateTries = sat.decisions;
+        conflicts = sat.conflicts;
+        if (progress) {
+            progress->candidateTries.fetch_add(candidateTries, memory_order_relaxed);
+        }
+    }
+    
+private:
+    const GcdInstance& instance;
+    
+    static vector<int> toLiterals(const vector<int>& dimacs) {
+        vector<int> lits;
+        for (int x : dimacs) {
+            lits.push_back(x > 0 ? 2 * (x - 1) : 2 * (-x - 1) + 1);
+        }
+        return lits;
+    }
+};
+
+//--------------------------------------------------------------------
+// Bit-parallel clique search
+//--------------------------------------------------------------------
+
+// A grid is a 9-clique of the graph whose vertices are the row candidates and whose edges
+// join compatible candidates of different rows. The clique engine keeps, per search level,
+// every row's remaining candidates as one bitset (the rows' blocks laid end to end), so
+// placing a candidate is a single AND with its adjacency row.
+const size_t CLIQUE_MAX_ADJACENCY_BYTES = size_t(256) << 20;
+
+// Shallowest level at which the clique engine colours a branch before entering it. Above it
+// the live candidates are many, and colouring them costs more than the branches it cuts.
+const int CLIQUE_COLOURING_MIN_DEPTH = 3;
+
+// Bytes of the clique engine's adjacency matrix for the instance.
+size_t cliqueAdjacencyBytes(const GcdInstance& instance) {
+    size_t vertices = 0;
+    size_t words = 0;
+    for (int r = 0; r < 9; r++) {
+        vertices += instance.candidates[r].size();
+        words += (instance.candidates[r].size() + 63) / 64;
+    }
+    return vertices * words * sizeof(uint64_t);
+}
+
+// Multi-partite clique search over the compatibility graph. Placing a candidate ANDs its
+// adjacency into every row's live set, and a branch dies when an unplaced row is left empty.
+// From CLIQUE_COLOURING_MIN_DEPTH on, a surviving branch is also bounded by a greedy colouring:
+// the live candidates of the unplaced rows are split first-fit into independent sets, and
+// since a clique takes at most one vertex per set, fewer sets than unplaced rows means no
+// completion. It branches on the
+// row with the fewest live candidates, in instance order within the row, and breaks
+// instance.rowSymmetries with the same lex-leader test as RowSolver. candidateTries counts
+// the candidates placed.
+class CliqueRowSolver : public InstanceSolver {
+public:
+    explicit CliqueRowSolver(const GcdInstance& instance) : instance(instance) {}
+    
+    void run() override {
+        PhaseScope phase(PHASE_CLIQUE);
+        buildAdjacency();
+        domains.assign(10 * domainWords, 0);
+        uncoloured.assign(domainWords, 0);
+        colourable.assign(domainWords, 0);
+        for (int r = 0; r < 9; r++) {
+            size_t n = instance.candidates[r].size();
+            for (size_t i = 0; i < n; i++) {
+                domains[offset[r] + i / 64] |= 1ULL << (i % 64);
+            }
+        }
+        placed.fill(false);
+        aborted = false;
+        search(0);
+        flushProgress();
+        exhausted = !aborted && !(firstSolution && !solutions.empty());
+    }
+    
+private:
+    const GcdInstance& instance;
+    array<size_t, 9> offset;                // first word of each row's block
+    array<size_t, 9> words;                 // words in each row's block
+    size_t domainWords = 0;
+    vector<uint64_t> adjacency;             // domainWords per vertex, vertices row by row
+    array<size_t, 9> firstVertex;
+    vector<uint64_t> domains;               // one set of row blocks per search level
+    vector<uint64_t> uncoloured;            // colouring bound scratch: vertices not yet coloured
+    vector<uint64_t> colourable;            // and those the current colour can still take
+    array<uint32_t, 9> chosen;
+    array<uint32_t, 9> placedValue;
+    array<bool, 9> placed;
+    bool aborted = false;
+    unsigned long long reportedTries = 0;
+    
+    static bool compatible(const CandidateBits& a, const CandidateBits& b, bool sameBand) {
+        uint64_t hiMask = sameBand ? ~0ULL : COLUMN_BITS_HI_MASK;
+        return (a.lo & b.lo) == 0 && (a.hi & b.hi & hiMask) == 0;
+    }
+    
+    void buildAdjacency() {
+        domainWords = 0;
+        size_t vertices = 0;
+        for (int r = 0; r < 9; r++) {
+            offset[r] = domainWords;
+            words[r] = (instance.candidates[r].size() + 63) / 64;
+            domainWords += words[r];
+            firstVertex[r] = vertices;
+            vertices += instance.candidates[r].size();
+        }
+        adjacency.assign(vertices * domainWords, 0);
+        for (int r = 0; r < 9; r++) {
+            for (int s = r + 1; s < 9; s++) {
+                bool sameBand = r / 3 == s / 3;
+                const vector<CandidateBits>& a = instance.candidateBits[r];
+                const vector<CandidateBits>& b = instance.candidateBits[s];
+                for (size_t i = 0; i < a.size(); i++) {
+                    uint64_t* rowI = &adjacency[(firstVertex[r] + i) * domainWords];
+                    for (size_t j = 0; j < b.size(); j++) {
+                        if (!compatible(a[i], b[j], sameBand)) continue;
+                        rowI[offset[s] + j / 64] |= 1ULL << (j % 64);
+                        adjacency[(firstVertex[s] + j) * domainWords + offset[r] + i / 64] |= 1ULL << (i % 64);
+                    }
+                }
+            }
+        }
+    }
+    
+    size_t blockCount(const uint64_t* domain, int r) const {
+        size_t count = 0;
+        for (size_t w = 0; w < words[r]; w++) {
+            count += __builtin_popcountll(domain[offset[r] + w]);
+        }
+        return count;
+    }
+    
+    // True if the live candidates of the unplaced rows need at least `needed` colours under
+    // first-fit greedy colouring; builds at most needed - 1 colours before deciding.
+    bool colouringAllows(const uint64_t* domain, int needed) {
+        for (int s = 0; s < 9; s++) {
+            for (size_t v = offset[s]; v < offset[s] + words[s]; v++) {
+                uncoloured[v] = placed[s] ? 0 : domain[v];
+            }
+        }
+        for (int colour = 0; colour < needed - 1; colour++) {
+            colourable = uncoloured;
+            bool laterOpen = true;          // some vertex of a later row can still join
+            for (int s = 0; s < 9; s++) {
+                for (size_t w = 0; w < words[s]; w++) {
+                    uint64_t& bits = colourable[offset[s] + w];
+                    while (bits) {
+                        if (!laterOpen) {
+                            // Rows are independent sets: the rest of this row joins as is.
+                            uncoloured[offset[s] + w] &= ~bits;
+                            bits = 0;
+                            break;
+                        }
+                        size_t i = w * 64 + __builtin_ctzll(bits);
+                        bits &= bits - 1;
+                        uncoloured[offset[s] + w] &= ~(1ULL << (i % 64));
+                        const uint64_t* neighbours = &adjacency[(firstVertex[s] + i) * domainWords];
+                        uint64_t any = 0;
+                        for (int t = s + 1; t < 9; t++) {
+                            if (placed[t]) continue;
+                            for (size_t v = offset[t]; v < offset[t] + words[t]; v++) {
+                                colourable[v] &= ~neighbours[v];
+                                any |= colourable[v];
+                            }
+                        }
+                        laterOpen = any != 0;
+                    }
+                }
+            }
+        }
+        for (size_t v = 0; v < domainWords; v++) {
+            if (uncoloured[v]) return true;
+        }
+        return false;
+    }
+    
+    bool breaksSymmetry() const {
+        for (const array<int, 9>& perm : instance.rowSymmetries) {
+            for (int r = 0; r < 9; r++) {
+                int s = perm[r];
+                if (s == r) continue;
+                if (!placed[r] || !placed[s] || placedValue[r] < placedValue[s]) break;
+                if (placedValue[r] > placedValue[s]) return true;
+            }
+        }
+        return false;
+    }
+    
+    void flushProgress() {
+        if (progress) {
+            progress->candidateTries.fetch_add(candidateTries - reportedTries, memory_order_relaxed);
+        }
+        reportedTries = candidateTries;
+    }
+    
+    bool shouldStop() {
+        if (firstSolution && !solutions.empty()) return true;
+        if (aborted) return true;
+        if (stop && stop->load(memory_order_relaxed)) {
+            aborted = true;
+        }
+        return aborted;
+    }
+    
+    void record() {
+        vector<vector<int>> grid(9);
+        for (int r = 0; r < 9; r++) {
+            grid[r] = instance.candidates[r][chosen[r]];
+        }
+        // Same acceptance rule as RowSolver: some cell of the first three columns is 0.
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 9; r++) {
+                if (grid[r][c] == 0) {
+                    solutions.push_back(move(grid));
+                    return;
+                }
+            }
+        }
+    }
+    
+    void search(int depth) {
+        if (depth == 9) {
+            record();
+            return;
+        }
+        if (shouldStop()) return;
+        
+        profileTag.depth = depth;
+        const uint64_t* domain = &domains[depth * domainWords];
+        uint64_t* child = &domains[(depth + 1) * domainWords];
+        int r = -1;
+        size_t fewest = SIZE_MAX;
+        for (int s = 0; s < 9; s++) {
+            if (placed[s]) continue;
+            size_t count = blockCount(domain, s);
+            if (count < fewest) {
+                r = s;
+                fewest = count;
+            }
+        }
+        placed[r] = true;
+        
+        for (size_t w = 0; w < words[r]; w++) {
+            uint64_t bits = domain[offset[r] + w];
+            while (bits) {
+                uint32_t i = uint32_t(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                candidateTries++;
+                if (candidateTries - reportedTries >= (1 << 16)) flushProgress();
+                chosen[r] = i;
+                placedValue[r] = instance.values[r][i];
+                if (!instance.rowSymmetries.empty() && breaksSymmetry()) continue;
+                
+                // Forward check: every unplaced row must keep a candidate.
+                const uint64_t* neighbours = &adjacency[(firstVertex[r] + i) * domainWords];
+                bool viable = true;
+                for (int s = 0; s < 9; s++) {
+                    uint64_t any = 0;
+                    for (size_t v = offset[s]; v < offset[s] + words[s]; v++) {
+                        child[v] = domain[v] & neighbours[v];
+                        any |= child[v];
+                    }
+                    if (!placed[s] && any == 0) {
+                        viable = false;
+                        break;
+                    }
+                }
+                if (viable && depth >= CLIQUE_COLOURING_MIN_DEPTH && 8 - depth >= 2) {
+                    viable = colouringAllows(child, 8 - depth);
+                }
+                if (viable) {
+                    search(depth + 1);
+                    profileTag.depth = depth;
+                }
+                if (shouldStop()) break;
+            }
+            if (aborted || (firstSolution && !solutions.empty())) break;
+        }
+        placed[r] = false;
+    }
+};
+
+//--------------------------------------------------------------------
+// Digit placement search
+//--------------------------------------------------------------------
+
+// Rows with at most this many open cells are checked for a completion to residue 0 by
+// trying every assignment of their remaining digits (at most 5 * 4 * 3 * 2 of them).
+const int DIGITS_RESIDUE_OPEN_CELLS = 4;
+
+// Places the grid one digit at a time instead of one row at a time: for digit 0, then 1, ...
+// each row in turn gets the digit in one open cell its column and box still allow, or (once
+// per row) leaves it out. The instance is meant to be the base rows, not filtered by the GCD:
+// every row's value modulo gcd is kept up to date, so a branch is cut as soon as a row with
+// few open cells can no longer reach residue 0, before the row is complete. Each row also
+// keeps the bitset of its candidates that agree with its own cells and don't clash with the
+// digits placed in other rows; a branch dies with a row's last one. The solutions are
+// RowSolver's on the rows divisible by gcd (orbit representatives under
+// instance.rowSymmetries, tested on the full grid). candidateTries counts digit placements,
+// leaving a digit out included.
+class DigitPlacementSolver : public InstanceSolver {
+public:
+    DigitPlacementSolver(const GcdInstance& instance, uint32_t gcd) : instance(instance), gcd(gcd) {}
+    
+    void run() override {
+        PhaseScope phase(PHASE_DIGITS);
+        modulus = max(1u, gcd);
+        uint32_t power = 1 % modulus;
+        for (int c = 8; c >= 0; c--) {
+            placeValue[c] = power;
+            power = uint32_t(uint64_t(power) * 10 % modulus);
+        }
+        buildSets();
+        for (int r = 0; r < 9; r++) {
+            grid[r].fill(-1);
+            residue[r] = 0;
+            missing[r] = -1;
+        }
+        aborted = false;
+        place(0, 0);
+        flushProgress();
+        exhausted = !aborted && !(firstSolution && !solutions.empty());
+    }
+    
+private:
+    const GcdInstance& instance;
+    uint32_t gcd;
+    uint32_t modulus = 1;
+    array<uint32_t, 9> placeValue;          // 10^(8-c) mod the GCD
+    array<size_t, 9> offset;                // first word of each row's candidate bitset
+    array<size_t, 9> words;
+    size_t totalWords = 0;
+    vector<uint64_t> withDigit;             // per cell and digit (c * 10 + d), every row's candidates having it
+    vector<uint64_t> withoutDigit;          // per digit, every row's candidates leaving it out
+    vector<uint64_t> live;                  // per step (d * 9 + r, 0..90), the candidates still possible
+    array<array<int, 9>, 9> grid;
+    array<uint32_t, 9> residue;
+    array<int, 9> missing;
+    array<int, DIGITS_RESIDUE_OPEN_CELLS> openCells;    // rowViable scratch: the row's open cells
+    array<int, DIGITS_RESIDUE_OPEN_CELLS> cellDigits;   // and the digits each can still take
+    bool aborted = false;
+    unsigned long long reportedTries = 0;
+    
+    void buildSets() {
+        totalWords = 0;
+        for (int r = 0; r < 9; r++) {
+            offset[r] = totalWords;
+            words[r] = (instance.candidates[r].size() + 63) / 64;
+            totalWords += words[r];
+        }
+        withDigit.assign(90 * totalWords, 0);
+        withoutDigit.assign(10 * totalWords, 0);
+        live.assign(91 * totalWords, 0);
+        for (int r = 0; r < 9; r++) {
+            for (size_t i = 0; i < instance.candidates[r].size(); i++) {
+                size_t word = offset[r] + i / 64;
+                uint64_t bit = 1ULL << (i % 64);
+                int present = 0;
+                for (int c = 0; c < 9; c++) {
+                    int d = instance.candidates[r][i][c];
+                    withDigit[(c * 10 + d) * totalWords + word] |= bit;
+                    present |= 1 << d;
+                }
+                for (int d = 0; d < 10; d++) {
+                    if (!(present >> d & 1)) withoutDigit[d * totalWords + word] |= bit;
+                }
+                live[word] |= bit;
+            }
+        }
+    }
+    
+    // Step k's sets narrowed into step k + 1's: row r keeps the candidates in keep (a set over
+    // all rows), and with cell c given d, the other rows drop their candidates with d in
+    // column c and the band's rows those with d in the box. False if some row has none left.
+    bool narrow(int k, int r, const uint64_t* keep, int c, int d) {
+        const uint64_t* from = &live[k * totalWords];
+        uint64_t* to = &live[(k + 1) * totalWords];
+        copy(from, from + totalWords, to);
+        for (int s = 0; s < 9; s++) {
+            uint64_t any = 0;
+            for (size_t w = offset[s]; w < offset[s] + words[s]; w++) {
+                uint64_t kept = to[w];
+                if (s == r) {
+                    kept &= keep[w];
+                } else if (c >= 0) {
+                    kept &= ~withDigit[(c * 10 + d) * totalWords + w];
+                    if (s / 3 == r / 3) {
+                        for (int b = c - c % 3; b < c - c % 3 + 3; b++) {
+                            kept &= ~withDigit[(b * 10 + d) * totalWords + w];
+                        }
+                    }
+                }
+                to[w] = kept;
+                any |= kept;
+            }
+            if (any == 0) return false;
+        }
+        return true;
+    }
+    
+    // Row r, done with digit d, can still reach a multiple of the GCD: with at most
+    // DIGITS_RESIDUE_OPEN_CELLS open cells, some assignment of distinct digits above d, each
+    // one its remaining candidates put in that cell, gives residue 0.
+    bool rowViable(int k, int r, int d) {
+        int n = 0;
+        for (int c = 0; c < 9 && n <= DIGITS_RESIDUE_OPEN_CELLS; c++) {
+            if (grid[r][c] < 0) {
+                if (n < DIGITS_RESIDUE_OPEN_CELLS) openCells[n] = c;
+                n++;
+            }
+        }
+        if (n == 0) return residue[r] == 0;
+        if (n > DIGITS_RESIDUE_OPEN_CELLS) return true;
+        const uint64_t* rowLive = &live[(k + 1) * totalWords];
+        for (int i = 0; i < n; i++) {
+            cellDigits[i] = 0;
+            for (int e = d + 1; e < 10; e++) {
+                const uint64_t* having = &withDigit[(openCells[i] * 10 + e) * totalWords];
+                for (size_t w = offset[r]; w < offset[r] + words[r]; w++) {
+                    if (rowLive[w] & having[w]) {
+                        cellDigits[i] |= 1 << e;
+                        break;
+                    }
+                }
+            }
+        }
+        return reachesZero(n, 0, residue[r], 0);
+    }
+    
+    // Open cells i.. of rowViable's row, with residue so far and the digits used, can be
+    // filled to residue 0.
+    bool reachesZero(int n, int i, uint32_t partial, int used) const {
+        if (i == n) return partial == 0;
+        for (int e = 0; e < 10; e++) {
+            if (!(cellDigits[i] >> e & 1) || (used >> e & 1)) continue;
+            uint32_t next = uint32_t((partial + uint64_t(e) * placeValue[openCells[i]]) % modulus);
+            if (reachesZero(n, i + 1, next, used | 1 << e)) return true;
+        }
+        return false;
+    }
+    
+    // Lex-leader test on the finished grid: rows the permutation leaves in place are skipped,
+    // and the first row that differs from its image decides.
+    bool breaksSymmetry(const array<uint32_t, 9>& values) const {
+        for (const array<int, 9>& perm : instance.rowSymmetries) {
+            for (int r = 0; r < 9; r++) {
+                int s = perm[r];
+                if (s == r) continue;
+                if (values[r] < values[s]) break;
+                if (values[r] > values[s]) return true;
+            }
+        }
+        return false;
+    }
+    
+    void record() {
+        array<uint32_t, 9> values;
+        for (int r = 0; r < 9; r++) {
+            values[r] = 0;
+            for (int c = 0; c < 9; c++) values[r] = values[r] * 10 + uint32_t(grid[r][c]);
+        }
+        if (breaksSymmetry(values)) return;
+        bool zeroInFirstColumns = false;
+        for (int r = 0; r < 9; r++) {
+            for (int c = 0; c < 3; c++) {
+                zeroInFirstColumns = zeroInFirstColumns || grid[r][c] == 0;
+            }
+        }
+        if (!zeroInFirstColumns) return;
+        vector<vector<int>> solution(9);
+        for (int r = 0; r < 9; r++) {
+            solution[r].assign(grid[r].begin(), grid[r].end());
+        }
+        solutions.push_back(move(solution));
+    }
+    
+    void flushProgress() {
+        if (progress) {
+            progress->candidateTries.fetch_add(candidateTries - reportedTries, memory_order_relaxed);
+        }
+        reportedTries = candidateTries;
+    }
+    
+    bool shouldStop() {
+        if (firstSolution && !solutions.empty()) return true;
+        if (aborted) return true;
+        if (stop && stop->load(memory_order_relaxed)) {
+            aborted = true;
+        }
+        return aborted;
+    }
+    
+    void place(int d, int r) {
+        if (r == 9) {
+            d++;
+            r = 0;
+        }
+        if (d == 10) {
+            record();
+            return;
+        }
+        if (shouldStop()) return;
+        
+        int k = d * 9 + r;
+        const uint64_t* rowLive = &live[k * totalWords];
+        auto anyOf = [&](const uint64_t* set) {
+            for (size_t w = offset[r]; w < offset[r] + words[r]; w++) {
+                if (rowLive[w] & set[w]) return true;
+            }
+            return false;
+        };
+        
+        // Leave d out of the row.
+        const uint64_t* without = &withoutDigit[d * totalWords];
+        if (missing[r] < 0 && anyOf(without)) {
+            candidateTries++;
+            missing[r] = d;
+            if (narrow(k, r, without, -1, d) && rowViable(k, r, d)) place(d, r + 1);
+            missing[r] = -1;
+        }
+        
+        // Or put it in an open cell.
+        for (int c = 0; c < 9; c++) {
+            const uint64_t* having = &withDigit[(c * 10 + d) * totalWords];
+            if (grid[r][c] >= 0 || !anyOf(having)) continue;
+            if (shouldStop()) return;
+            candidateTries++;
+            if (candidateTries - reportedTries >= (1 << 16)) flushProgress();
+            grid[r][c] = d;
+            uint32_t oldResidue = residue[r];
+            residue[r] = uint32_t((residue[r] + uint64_t(d) * placeValue[c]) % modulus);
+            if (narrow(k, r, having, c, d) && rowViable(k, r, d)) place(d, r + 1);
+            residue[r] = oldResidue;
+            grid[r][c] = -1;
+        }
+    }
+};
+
+//--------------------------------------------------------------------
+// Portfolio racing
+//--------------------------------------------------------------------
+
+// One solver configuration raced in portfolio mode.
+struct PortfolioConfig {
+    string name;
+    bool satEngine;             // CDCL engine instead of row backtracking
+    bool generationOrder;       // candidates in permutation order instead of value-ordering order
+    bool dynamicRowOrder;       // branch on the most constrained row
+    bool forwardChecking;       // prune when an unplaced row runs out of candidates
+    bool randomizedRestarts;    // Luby-restarted randomized search (first-solution mode only)
+};
+
+vector<PortfolioConfig> portfolioConfigs(bool firstSolution) {
+    vector<PortfolioConfig> configs = {
+        {"fixed-lcv",        false, false, false, false, false},
+        {"fixed-generation", false, true,  false, false, false},
+        {"fixed-lcv-fc",     false, false, false, true,  false},
+        {"dynamic-lcv",      false, false, true,  true,  false},
+        {"sat",              true,  false, false, false, false},
+    };
+    if (firstSolution) {
+        configs.push_back({"randomized-restarts", false, false, false, false, true});
+    }
+    return configs;
+}
+
+struct PortfolioResult {
+    vector<vector<vector<int>>> solutions;
+    unsigned long long candidateTries = 0;  // summed over all configurations
+    string winner;
+    double winnerSeconds = 0;
+};
+
+// Race every configuration on the same instance, one thread each. The first to reach a
+// definitive answer (its first solution in first-solution mode, otherwise a complete
+// enumeration, which is also the proof of infeasibility when it finds nothing) wins and
+// the others are stopped. In deterministic mode nobody is stopped: every configuration runs
+// to its answer and the first one in list order wins, so the result and the counters don't
+// depend on thread timing (at the cost of waiting for the slowest configuration). With
+// replicas, configuration i is pinned to node i mod nodes and searches that node's copy.
+PortfolioResult solvePortfolio(const GcdInstance& shared, const KernelSet& kernels, const vector<int>& rowOrder,
+                               bool firstSolution, unsigned long long restartUnit, uint64_t seed,
+                               SearchProgress* progress, bool deterministic = false,
+                               const InstanceReplicas* replicas = nullptr, PoolTelemetry* telemetry = nullptr) {
+    vector<PortfolioConfig> configs = portfolioConfigs(firstSolution);
+    PortfolioResult result;
+    mutex resultMutex;
+    atomic<bool> done{false};
+    auto startTime = chrono::steady_clock::now();
+    
+    // Generation order is recovered from the base-list positions.
+    array<vector<uint32_t>, 9> generationOrder;
+    for (int r = 0; r < 9; r++) {
+        generationOrder[r].resize(shared.candidates[r].size());
+        for (uint32_t i = 0; i < generationOrder[r].size(); i++) {
+            generationOrder[r][i] = i;
+        }
+        sort(generationOrder[r].begin(), generationOrder[r].end(),
+             [&](uint32_t a, uint32_t b) { return shared.baseIndex[r][a] < shared.baseIndex[r][b]; });
+    }
+    
+    // Deterministic mode: each configuration's answer, kept for picking the winner afterwards.
+    vector<bool> answered(configs.size(), false);
+    vector<double> answerSeconds(configs.size(), 0);
+    vector<vector<vector<vector<int>>>> answers(configs.size());
+    
+    auto finish = [&](const PortfolioConfig& config, vector<vector<vector<int>>>& solutions) {
+        lock_guard<mutex> guard(resultMutex);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        if (deterministic) {
+            size_t index = &config - configs.data();
+            answered[index] = true;
+            answerSeconds[index] = seconds;
+            answers[index] = move(solutions);
+        } else if (result.winner.empty()) {
+            result.winner = config.name;
+            result.winnerSeconds = seconds;
+            result.solutions = move(solutions);
+        }
+    };
+    
+    auto race = [&](const PortfolioConfig& config) {
+        int index = int(&config - configs.data());
+        NodeAffinity pin(replicas ? replicas->nodeFor(index) : nullptr);
+        const GcdInstance& instance = replicas ? replicas->instanceFor(index, shared) : shared;
+        auto raceStart = PoolTelemetry::Clock::now();
+        unsigned long long tries = 0;
+        if (config.randomizedRestarts) {
+            RestartResult restart = deterministic
+                ? solveWithRestartsInRounds(instance, kernels, restartUnit, 1, seed, progress)
+                : solveWithRestarts(instance, kernels, restartUnit, 1, seed, progress, &done);
+            tries = restart.candidateTries;
+            if (restart.found || restart.exhausted) {
+                vector<vector<vector<int>>> solutions;
+                if (restart.found) {
+                    solutions.push_back(restart.solution);
+                }
+                finish(config, solutions);
+            }
+        } else {
+            unique_ptr<InstanceSolver> solver;
+            if (config.satEngine) {
+                solver.reset(new SatRowSolver(instance));
+            } else {
+                RowSolver* rows = new RowSolver(instance, kernels, rowOrder);
+                if (config.generationOrder) {
+                    for (int r = 0; r < 9; r++) {
+                        rows->setValueOrder(r, generationOrder[r]);
+                    }
+                }
+                rows->dynamicRowOrder = config.dynamicRowOrder;
+                rows->forwardChecking = config.forwardChecking;
+                solver.reset(rows);
+            }
+            solver->firstSolution = firstSolution;
+            solver->stop = deterministic ? nullptr : &done;
+            solver->progress = progress;
+            solver->run();
+            tries = solver->candidateTries;
+            if (solver->exhausted || (firstSolution && !solver->solutions.empty())) {
+                done = true;
+                finish(config, solver->solutions);
+            }
+        }
+        if (telemetry) telemetry->task("portfolio", index, raceStart, PoolTelemetry::Clock::now(), config.name);
+        lock_guard<mutex> guard(resultMutex);
+        result.candidateTries += tries;
+    };
+    
+    vector<thread> threads;
+    for (size_t i = 1; i < configs.size(); i++) {
+        threads.emplace_back(race, cref(configs[i]));
+    }
+    race(configs[0]);
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (telemetry) telemetry->stageFinished("portfolio", int(configs.size()), startTime);
+    for (size_t i = 0; deterministic && i < configs.size(); i++) {
+        if (answered[i]) {
+            result.winner = configs[i].name;
+            result.winnerSeconds = answerSeconds[i];
+            result.solutions = move(answers[i]);
+            break;
+        }
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------
+// Reference oracles and differential self-check
+//--------------------------------------------------------------------
+// The string-based helpers above and referenceSolveFixed (the original recursive search,
+// kept as written) define the expected results. runSelfCheck compares every kernel set,
+// every solver configuration and the SAT engine against them on random data.
+
+void referenceSolveFixed(const vector<vector<vector<int>>>& candidates, const vector<int>& rowOrder,
+                         vector<vector<vector<int>>>& allSolutions, unsigned long long& candidateTries) {
+    // Initialize constraint masks and solution grid.
+    array<int, 9> colMask = {0,0,0,0,0,0,0,0,0};
+    array<int, 9> boxMask = {0,0,0,0,0,0,0,0,0};
+    vector<vector<int>> solution(9, vector<int>(9, 0));
+    
+    // Helper lambda: check if at least one of the first columns has a 0
+    auto hasZeroInFirstColumns = [&solution]() -> bool {
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 9; r++) {
+                if (solution[r][c] == 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    
+    function<void(int)> solveFixed = [&](int pos) {
+        if (pos == 9) {
+            if (hasZeroInFirstColumns()) {
+                allSolutions.push_back(solution);
+            }
+            return;
+        }
+        int r = rowOrder[pos];
+        for (const auto &cand : candidates[r]) {
+            candidateTries++;
+            bool conflict = false;
+            for (int c = 0; c < 9 && !conflict; c++) {
+                int d = cand[c];
+                int b = (r / 3) * 3 + (c / 3);
+                conflict = (colMask[c] & (1 << d)) || (boxMask[b] & (1 << d));
+            }
+            if (conflict) continue;
+            
+            array<int, 9> oldColMask = colMask;
+            array<int, 9> oldBoxMask = boxMask;
+            for (int c = 0; c < 9; c++) {
+                int d = cand[c];
+                colMask[c] |= (1 << d);
+                boxMask[(r / 3) * 3 + (c / 3)] |= (1 << d);
+                solution[r][c] = d;
+            }
+            solveFixed(pos + 1);
+            colMask = oldColMask;
+            boxMask = oldBoxMask;
+        }
+    };
+    solveFixed(0);
+}
+
+namespace {
+
+// A random 9-digit string over nine distinct digits (one of the generated numbers).
+string randomNumber(mt19937_64& rng) {
+    string digits = "0123456789";
+    shuffle(digits.begin(), digits.end(), rng);
+    return digits.substr(0, 9);
+}
+
+// A random valid grid over the given nine digits: the standard pattern shuffled by row moves
+// within bands, band moves, column moves within stacks and stack moves.
+vector<vector<int>> randomGrid(const string& digits, mt19937_64& rng) {
+    array<int, 9> rows, cols;
+    array<int, 3> bands = {0, 1, 2}, stacks = {0, 1, 2};
+    shuffle(bands.begin(), bands.end(), rng);
+    shuffle(stacks.begin(), stacks.end(), rng);
+    for (int b = 0; b < 3; b++) {
+        array<int, 3> inner = {0, 1, 2};
+        shuffle(inner.begin(), inner.end(), rng);
+        for (int i = 0; i < 3; i++) rows[3 * b + i] = 3 * bands[b] + inner[i];
+        shuffle(inner.begin(), inner.end(), rng);
+        for (int i = 0; i < 3; i++) cols[3 * b + i] = 3 * stacks[b] + inner[i];
+    }
+    vector<vector<int>> grid(9, vector<int>(9));
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            grid[r][c] = digits[(3 * (rows[r] % 3) + rows[r] / 3 + cols[c]) % 9] - '0';
+        }
+    }
+    return grid;
+}
+
+// Conflict bits, base indices and values for an instance whose candidates are set.
+void fillCandidateData(GcdInstance& instance) {
+    for (int r = 0; r < 9; r++) {
+        instance.candidateBits.emplace_back();
+        instance.baseIndex.emplace_back();
+        instance.values.emplace_back();
+        for (size_t i = 0; i < instance.candidates[r].size(); i++) {
+            string s;
+            for (int d : instance.candidates[r][i]) s.push_back(char('0' + d));
+            instance.candidateBits[r].push_back(makeCandidateBits(s));
+            instance.baseIndex[r].push_back(uint32_t(i));
+            instance.values[r].push_back(numberValue(s));
+        }
+    }
+}
+
+// A small random instance: every row holds the rows of a few random grids over one digit set
+// (so solutions exist, some mixing the grids) plus random decoys, in random order. Its GCD
+// divides every row of the first grid, or is small and random.
+GcdInstance randomInstance(mt19937_64& rng) {
+    string digits = randomNumber(rng);
+    sort(digits.begin(), digits.end());
+    vector<vector<vector<int>>> grids;
+    for (int g = int(rng() % 3) + 1; g > 0; g--) {
+        grids.push_back(randomGrid(digits, rng));
+    }
+    
+    GcdInstance instance;
+    uint32_t shared = 0;
+    for (const vector<int>& row : grids[0]) {
+        uint32_t value = 0;
+        for (int d : row) value = value * 10 + uint32_t(d);
+        shared = gcd(shared, value);
+    }
+    instance.gcd = rng() % 2 ? int(shared) : int(2 + rng() % 30);
+    instance.candidates.resize(9);
+    for (int r = 0; r < 9; r++) {
+        set<vector<int>> seen;
+        for (const auto& grid : grids) {
+            seen.insert(grid[r]);
+        }
+        for (int extra = int(rng() % 12); extra > 0; extra--) {
+            string s = digits;
+            shuffle(s.begin(), s.end(), rng);
+            vector<int> cand;
+            for (char c : s) cand.push_back(c - '0');
+            seen.insert(cand);
+        }
+        instance.candidates[r].assign(seen.begin(), seen.end());
+        shuffle(instance.candidates[r].begin(), instance.candidates[r].end(), rng);
+    }
+    // Now and then make two rows of a band interchangeable, for the symmetry breaking.
+    if (rng() % 4 == 0) {
+        int band = int(rng() % 3);
+        instance.candidates[3 * band + 1] = instance.candidates[3 * band];
+    }
+    
+    fillCandidateData(instance);
+    return instance;
+}
+
+array<uint32_t, 9> packGrid(const vector<vector<int>>& grid) {
+    array<uint32_t, 9> rows;
+    for (int r = 0; r < 9; r++) {
+        uint32_t value = 0;
+        for (int d : grid[r]) {
+            value = value * 10 + uint32_t(d);
+        }
+        rows[r] = value;
+    }
+    return rows;
+}
+
+vector<vector<vector<int>>> sorted(vector<vector<vector<int>>> solutions) {
+    sort(solutions.begin(), solutions.end());
+    return solutions;
+}
+
+// The grids that are no greater than any of their images under the symmetries (rows compared
+// top-down), i.e. the one representative per orbit that the symmetry-breaking solvers keep.
+vector<vector<vector<int>>> orbitLeaders(const vector<vector<vector<int>>>& grids,
+                                         const vector<array<int, 9>>& symmetries) {
+    vector<vector<vector<int>>> leaders;
+    for (const vector<vector<int>>& grid : grids) {
+        bool leader = true;
+        for (const array<int, 9>& perm : symmetries) {
+            vector<vector<int>> image(9);
+            for (int r = 0; r < 9; r++) {
+                image[r] = grid[perm[r]];
+            }
+            leader = leader && !(image < grid);
+        }
+        if (leader) leaders.push_back(grid);
+    }
+    return leaders;
+}
+
+} // namespace
+
+SelfCheckReport runSelfCheck(uint64_t seed, size_t iterations) {
+    SelfCheckReport report;
+    mt19937_64 rng(seed);
+    vector<const KernelSet*> kernelSets = supportedKernelSets();
+    auto check = [&report](bool ok, const string& what) {
+        report.cases++;
+        if (!ok && report.failures.size() < 100) {
+            report.failures.push_back(what);
+        }
+    };
+    
+    // Symmetry breaking that leaves row 0 in place: rows 1 and 2 can take each other's row of
+    // a grid and every other row is fixed, so the grid and its swap form one orbit and the
+    // digit engine must keep only the smaller.
+    {
+        GcdInstance instance;
+        instance.gcd = 1;
+        vector<vector<int>> grid = randomGrid("012345678", rng);
+        instance.candidates.resize(9);
+        for (int r = 0; r < 9; r++) {
+            instance.candidates[r] = {grid[r]};
+        }
+        instance.candidates[1] = {grid[1], grid[2]};
+        instance.candidates[2] = instance.candidates[1];
+        fillCandidateData(instance);
+        instance.rowSymmetries = instanceRowSymmetries(instance);
+        vector<vector<int>> swapped = grid;
+        swap(swapped[1], swapped[2]);
+        DigitPlacementSolver digits(instance, 1);
+        digits.run();
+        check(digits.exhausted && digits.solutions == vector<vector<vector<int>>>{min(grid, swapped)},
+              "DigitPlacementSolver (symmetry fixing row 0)");
+    }
+    
+    // The invariant prefilter: row 1 leaves out 1 or 3 and row 2 leaves out 1 or 6, so each has
+    // candidates divisible by 3, but only by leaving out different digits. Leaving out 1 (digit
+    // sum 44) is all they share, and no grid can have 3 in every row.
+    {
+        array<ColumnMasks, 9> rowMasks;
+        for (ColumnMasks& masks : rowMasks) masks.fill(ALL_DIGITS_MASK);
+        for (int c = 1; c < 9; c++) {
+            disallowDigits(rowMasks[0], c, {'1', '3'});
+            disallowDigits(rowMasks[1], c, {'1', '6'});
+        }
+        rowMasks[0][0] = (1 << 1) | (1 << 3);
+        rowMasks[1][0] = (1 << 1) | (1 << 6);
+        Engine engine;
+        engine.generate({}, 1);
+        engine.filterRows(rowMasks);
+        vector<uint32_t> excluded = engine.invariantExclusions();
+        check(find(excluded.begin(), excluded.end(), 3u) != excluded.end(), "invariantExclusions (3 by missing digit)");
+    }
+    
+    // One missing digit per grid, for every engine: turning row 0's 0 into the 9 that the grid
+    // leaves out keeps rows, columns and boxes free of repeats, but row 0 then leaves out 0
+    // and the other rows 9. The full grid is a clue, so only the original can be a solution.
+    {
+        vector<vector<int>> grid = randomGrid("012345678", rng);
+        vector<vector<int>> mixed = grid;
+        replace(mixed[0].begin(), mixed[0].end(), 0, 9);
+        for (const char* name : {"backtrack", "sat", "clique", "digits"}) {
+            EngineConfig config;
+            config.engine = name;
+            Engine engine(config);
+            engine.generate({}, 1);
+            for (const vector<vector<int>>* clues : {&grid, &mixed}) {
+                array<ColumnMasks, 9> rowMasks;
+                for (int r = 0; r < 9; r++) {
+                    for (int c = 0; c < 9; c++) rowMasks[r][c] = uint16_t(1 << (*clues)[r][c]);
+                }
+                engine.filterRows(rowMasks);
+                SolveResult result;
+                if (engine.filterDivisible(1)) result = engine.solve();
+                size_t expected = clues == &grid ? 1 : 0;
+                check(result.exhausted && result.solutions.size() == expected &&
+                      (expected == 0 || result.solutions.front() == packGrid(grid)),
+                      string("Engine::solve (") + name + (expected ? ", one missing digit)" : ", mixed missing digits)"));
+            }
+        }
+    }
+    
+    for (size_t iteration = 0; iteration < iterations; iteration++) {
+        string tag = "iteration " + to_string(iteration) + ": ";
+        
+        // Random numbers: generated-style ones and arbitrary digit strings.
+        vector<string> numbers(1 + rng() % 300);
+        for (string& number : numbers) {
+            number = rng() % 2 ? randomNumber(rng) : numberDigits(uint32_t(rng() % 1000000000));
+        }
+        vector<uint32_t> values;
+        for (const string& number : numbers) {
+            values.push_back(numberValue(number));
+        }
+        vector<uint32_t> indices(numbers.size());
+        
+        // Divisibility: filterDivisibleByCandidate against every kernel set.
+        // (The reference accumulates remainder * 10 in an int, so divisors stay below 2^31 / 10.)
+        uint32_t divisor = rng() % 4 == 0 ? uint32_t(1 + rng() % 20) : uint32_t(1 + rng() % 214748363);
+        if (rng() % 4 == 0 && !values.empty()) divisor = max(1u, values[rng() % values.size()] / uint32_t(1 + rng() % 50));
+        vector<string> expectedDivisible = filterDivisibleByCandidate(numbers, int(divisor));
+        for (const KernelSet* kernels : kernelSets) {
+            size_t kept = kernels->filterDivisible(values.data(), values.size(), divisor, indices.data());
+            vector<string> actual;
+            for (size_t i = 0; i < kept; i++) actual.push_back(numbers[indices[i]]);
+            check(actual == expectedDivisible, tag + kernels->name + " filterDivisible by " + to_string(divisor));
+        }
+        
+        // The digit-table split: multiply-shift quotients over the whole 32-bit range.
+        uint32_t dividend = uint32_t(rng());
+        check(divide1000(dividend) == dividend / 1000 && divide1000000(dividend) == dividend / 1000000,
+              tag + "multiply-shift division of " + to_string(dividend));
+        
+        // Clue masks: distinct digits, required digits and filterByColumn / filterDisallowedValues
+        // per cell, against the digit-table kernels.
+        vector<char> required;
+        for (char d = '0'; d <= '9'; d++) {
+            if (rng() % 5 == 0) required.push_back(d);
+        }
+        ColumnMasks masks;
+        vector<string> expectedRow;
+        for (const string& number : numbers) {
+            if (set<char>(number.begin(), number.end()).size() == 9 && containsRequiredDigits(number, required)) {
+                expectedRow.push_back(number);
+            }
+        }
+        for (int c = 0; c < 9; c++) {
+            int kind = int(rng() % 4);
+            masks[c] = ALL_DIGITS_MASK;
+            if (kind == 0) {
+                char value = char('0' + rng() % 10);
+                requireDigit(masks, c, value);
+                expectedRow = filterByColumn(expectedRow, c, value);
+            } else if (kind == 1) {
+                vector<char> disallowed;
+                for (char d = '0'; d <= '9'; d++) {
+                    if (rng() % 3 == 0) disallowed.push_back(d);
+                }
+                for (char d : disallowed) disallowDigits(masks, c, {d});
+                expectedRow = filterDisallowedValues(expectedRow, c, disallowed);
+            }
+        }
+        uint32_t requiredMask = 0;
+        for (char d : required) requiredMask |= 1u << (d - '0');
+        unique_ptr<DigitTables> tables(new DigitTables);
+        buildDigitTables(masks.data(), requiredMask, *tables);
+        // Values of 10^9 and up (10 digits, never a row) mixed in at random positions.
+        vector<uint32_t> tableValues;
+        vector<string> tableNumbers;
+        for (size_t i = 0; i < numbers.size(); i++) {
+            if (rng() % 8 == 0) {
+                uint32_t large = 1000000000u + uint32_t(rng() % 3294967296u);
+                tableValues.push_back(large);
+                tableNumbers.push_back(to_string(large));
+            }
+            tableValues.push_back(values[i]);
+            tableNumbers.push_back(numbers[i]);
+        }
+        vector<uint32_t> tableIndices(tableValues.size());
+        for (const KernelSet* kernels : kernelSets) {
+            size_t kept = kernels->filterDigitTables(tableValues.data(), tableValues.size(), *tables, tableIndices.data());
+            vector<string> actual;
+            for (size_t i = 0; i < kept; i++) actual.push_back(tableNumbers[tableIndices[i]]);
+            check(actual == expectedRow, tag + kernels->name + " filterDigitTables");
+        }
+        
+        // Small random puzzles: the reference search against every solver configuration.
+        GcdInstance instance = randomInstance(rng);
+        vector<int> rowOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+        shuffle(rowOrder.begin(), rowOrder.end(), rng);
+        vector<vector<vector<int>>> expected;
+        unsigned long long expectedTries = 0;
+        referenceSolveFixed(instance.candidates, rowOrder, expected, expectedTries);
+        vector<vector<vector<int>>> expectedSorted = sorted(expected);
+        
+        for (const KernelSet* kernels : kernelSets) {
+            // Same order and the same count of candidate tries as the reference.
+            RowSolver solver(instance, *kernels, rowOrder);
+            solver.run();
+            check(solver.solutions == expected && solver.candidateTries == expectedTries,
+                  tag + kernels->name + " RowSolver (fixed order)");
+        }
+        
+        GcdInstance ordered = instance;
+        ordered.rowSymmetries = instanceRowSymmetries(ordered);
+        orderLeastConstraining(ordered);
+        for (int variant = 0; variant < 2; variant++) {
+            RowSolver solver(ordered, *kernelSets.front(), rowOrder);
+            solver.dynamicRowOrder = variant == 1;
+            solver.forwardChecking = variant == 1;
+            solver.run();
+            check(sorted(expandSymmetricSolutions(solver.solutions, ordered.rowSymmetries)) == expectedSorted,
+                  tag + "RowSolver (lcv, symmetry breaking" + (variant ? ", dynamic, forward checking)" : ")"));
+        }
+        
+        SatRowSolver sat(instance);
+        sat.run();
+        check(sat.exhausted && sorted(sat.solutions) == expectedSorted, tag + "SatRowSolver");
+        
+        CliqueRowSolver clique(ordered);
+        clique.run();
+        check(clique.exhausted && sorted(expandSymmetricSolutions(clique.solutions, ordered.rowSymmetries)) == expectedSorted,
+              tag + "CliqueRowSolver (symmetry breaking)");
+        
+        // The digit engine on the same rows, unfiltered: the reference's grids whose rows are
+        // all multiples of the GCD.
+        uint32_t gcd = uint32_t(instance.gcd);
+        vector<vector<vector<int>>> expectedGrids;
+        for (const auto& grid : expectedSorted) {
+            bool divisible = true;
+            for (const vector<int>& row : grid) {
+                uint32_t value = 0;
+                for (int d : row) value = value * 10 + uint32_t(d);
+                divisible = divisible && value % gcd == 0;
+            }
+            if (divisible) expectedGrids.push_back(grid);
+        }
+        DigitPlacementSolver digits(ordered, gcd);
+        digits.run();
+        check(digits.exhausted && sorted(digits.solutions) == orbitLeaders(expectedGrids, ordered.rowSymmetries),
+              tag + "DigitPlacementSolver (GCD " + to_string(gcd) + ", symmetry breaking)");
+        
+        RestartResult restart = solveWithRestarts(instance, *kernelSets.front(), 1 + rng() % 50, 1, rng(), nullptr);
+        check(restart.found == !expected.empty() &&
+              (!restart.found || binary_search(expectedSorted.begin(), expectedSorted.end(), restart.solution)),
+              tag + "solveWithRestarts");
+        
+        // Lock-step restarts: same seed, same witness and counters.
+        uint64_t roundSeed = rng();
+        RestartResult first = solveWithRestartsInRounds(instance, *kernelSets.front(), 1 + roundSeed % 50, 2, roundSeed, nullptr);
+        RestartResult second = solveWithRestartsInRounds(instance, *kernelSets.front(), 1 + roundSeed % 50, 2, roundSeed, nullptr);
+        check(first.found == !expected.empty() && first.solution == second.solution &&
+              first.candidateTries == second.candidateTries && first.winningWorker == second.winningWorker,
+              tag + "solveWithRestartsInRounds");
+    }
+    return report;
+}
+
+//--------------------------------------------------------------------
+// Built-in puzzle
+//--------------------------------------------------------------------
+
+PuzzleDefinition january2025Puzzle() {
+    PuzzleDefinition puzzle;
+    puzzle.requiredDigits = {'0','2','5'};
+    puzzle.rowMasks = JANUARY_2025_MASKS;
+    return puzzle;
+}
+
+// Parses a digit list such as "025" into its mask; false on anything but digits.
+bool parseDigitMask(const string& digits, uint16_t& mask) {
+    mask = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        mask |= uint16_t(1 << (c - '0'));
+    }
+    return !digits.empty();
+}
+
+bool loadPuzzleDefinition(const string& path, PuzzleDefinition& puzzle, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    PuzzleDefinition loaded;
+    for (ColumnMasks& masks : loaded.rowMasks) {
+        masks.fill(ALL_DIGITS_MASK);
+    }
+    string line;
+    int lineNumber = 0;
+    while (getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+        string directive, digits;
+        int row = 0, column = 0;
+        if (!(fields >> directive)) continue;
+        uint16_t mask = 0;
+        bool ok;
+        if (directive == "digits") {
+            ok = bool(fields >> digits) && parseDigitMask(digits, mask);
+            loaded.requiredDigits.assign(digits.begin(), digits.end());
+        } else {
+            ok = bool(fields >> row >> column >> digits) && row >= 1 && row <= 9 && column >= 1 && column <= 9 &&
+                 parseDigitMask(digits, mask) && (directive != "require" || digits.size() == 1);
+            if (ok && (directive == "require" || directive == "allow")) {
+                loaded.rowMasks[row - 1][column - 1] &= mask;
+            } else if (ok && directive == "disallow") {
+                loaded.rowMasks[row - 1][column - 1] &= uint16_t(~mask);
+            } else {
+                ok = false;
+            }
+        }
+        if (!ok || (fields >> digits)) {
+            error = path + ":" + to_string(lineNumber) + ": cannot parse '" + line + "'";
+            return false;
+        }
+    }
+    uint16_t requiredMask = 0;
+    parseDigitMask(string(loaded.requiredDigits.begin(), loaded.requiredDigits.end()), requiredMask);
+    if (propagateClues(loaded.rowMasks, requiredMask) < 0) {
+        error = path + ": the clues contradict each other";
+        return false;
+    }
+    puzzle = loaded;
+    return true;
+}
+
+bool savePuzzleDefinition(const string& path, const PuzzleDefinition& puzzle) {
+    ofstream out(path);
+    out << "digits " << string(puzzle.requiredDigits.begin(), puzzle.requiredDigits.end()) << "\n";
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            uint16_t mask = puzzle.rowMasks[r][c];
+            if (mask == ALL_DIGITS_MASK) continue;
+            string digits;
+            for (int d = 0; d <= 9; d++) {
+                if (mask & (1 << d)) digits.push_back(char('0' + d));
+            }
+            if (digits.empty()) {
+                out << "disallow " << r + 1 << " " << c + 1 << " 0123456789\n";
+            } else {
+                out << (digits.size() == 1 ? "require " : "allow ") << r + 1 << " " << c + 1 << " " << digits << "\n";
+            }
+        }
+    }
+    return bool(out);
+}
+
+//--------------------------------------------------------------------
+// Sweep state
+//--------------------------------------------------------------------
+
+SweepState::Status SweepState::status(uint32_t gcd) const {
+    if (gcd < low || gcd - low >= statuses.size()) return UNKNOWN;
+    return Status(statuses[gcd - low]);
+}
+
+const vector<array<uint32_t, 9>>* SweepState::solutions(uint32_t gcd) const {
+    auto it = solutionsByGcd.find(gcd);
+    return it == solutionsByGcd.end() ? nullptr : &it->second;
+}
+
+void SweepState::record(uint32_t gcd, Status status, const vector<array<uint32_t, 9>>& solutions) {
+    if (statuses.empty()) {
+        low = gcd;
+    } else if (gcd < low) {
+        statuses.insert(statuses.begin(), low - gcd, uint8_t(UNKNOWN));
+        low = gcd;
+    }
+    if (gcd - low >= statuses.size()) {
+        statuses.resize(gcd - low + 1, uint8_t(UNKNOWN));
+    }
+    statuses[gcd - low] = status;
+    if (status == FEASIBLE || status == WITNESSED) {
+        solutionsByGcd[gcd] = solutions;
+    } else {
+        solutionsByGcd.erase(gcd);
+    }
+}
+
+size_t SweepState::recordedCount() const {
+    return statuses.size() - count(statuses.begin(), statuses.end(), uint8_t(UNKNOWN));
+}
+
+namespace {
+
+bool allowedByMasks(uint32_t value, const ColumnMasks& masks) {
+    for (int c = 8; c >= 0; c--, value /= 10) {
+        if (!(masks[c] & (1 << (value % 10)))) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+size_t SweepState::rebase(const PuzzleDefinition& edited) {
+    size_t dropped = 0;
+    if (edited.requiredDigits != puzzle.requiredDigits) {
+        // Different digit rules change every row; nothing recorded carries over.
+        dropped = recordedCount();
+        statuses.clear();
+        solutionsByGcd.clear();
+        puzzle = edited;
+        return dropped;
+    }
+    
+    // A row whose masks only lost digits keeps a subset of its base candidates.
+    array<bool, 9> tightened;
+    bool allTightened = true;
+    for (int r = 0; r < 9; r++) {
+        tightened[r] = true;
+        for (int c = 0; c < 9; c++) {
+            tightened[r] = tightened[r] && (edited.rowMasks[r][c] & ~puzzle.rowMasks[r][c]) == 0;
+        }
+        allTightened = allTightened && tightened[r];
+    }
+    
+    for (size_t i = 0; i < statuses.size(); i++) {
+        uint32_t gcd = uint32_t(low + i);
+        uint8_t current = statuses[i];
+        bool keep = true;
+        if (current >= EMPTY_ROW && current < EMPTY_ROW + 9) {
+            keep = tightened[current - EMPTY_ROW];
+        } else if (current == INFEASIBLE) {
+            keep = allTightened;
+        } else if (current == FEASIBLE || current == WITNESSED) {
+            // Old solutions still allowed are solutions of the edited puzzle; they are all of
+            // them only if no row gained candidates.
+            vector<array<uint32_t, 9>>& kept = solutionsByGcd[gcd];
+            kept.erase(remove_if(kept.begin(), kept.end(), [&](const array<uint32_t, 9>& grid) {
+                for (int r = 0; r < 9; r++) {
+                    if (!allowedByMasks(grid[r], edited.rowMasks[r])) return true;
+                }
+                return false;
+            }), kept.end());
+            keep = !kept.empty();
+            if (!keep) {
+                solutionsByGcd.erase(gcd);
+            } else if (!allTightened) {
+                statuses[i] = WITNESSED;
+            }
+        }
+        if (!keep) {
+            statuses[i] = UNKNOWN;
+            dropped++;
+        }
+    }
+    puzzle = edited;
+    return dropped;
+}
+
+// File layout (host byte order): "SQSWEEP2", required digit count and digits, 81 masks,
+// low, status count and statuses, then per feasible GCD: gcd, solution count and 9 rows each.
+bool SweepState::load(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[8];
+    if (!in.read(magic, 8) || string(magic, 8) != "SQSWEEP2") return false;
+    auto readU32 = [&](uint32_t& value) { return bool(in.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+    SweepState loaded;
+    uint32_t digitCount = 0, statusCount = 0, feasibleCount = 0;
+    if (!readU32(digitCount) || digitCount > 10) return false;
+    loaded.puzzle.requiredDigits.resize(digitCount);
+    in.read(loaded.puzzle.requiredDigits.data(), digitCount);
+    for (ColumnMasks& masks : loaded.puzzle.rowMasks) {
+        in.read(reinterpret_cast<char*>(masks.data()), sizeof(uint16_t) * 9);
+    }
+    if (!readU32(loaded.low) || !readU32(statusCount)) return false;
+    loaded.statuses.resize(statusCount);
+    in.read(reinterpret_cast<char*>(loaded.statuses.data()), statusCount);
+    if (!readU32(feasibleCount)) return false;
+    for (uint32_t i = 0; i < feasibleCount; i++) {
+        uint32_t gcd = 0, solutionCount = 0;
+        if (!readU32(gcd) || !readU32(solutionCount)) return false;
+        vector<array<uint32_t, 9>>& solutions = loaded.solutionsByGcd[gcd];
+        solutions.resize(solutionCount);
+        for (array<uint32_t, 9>& grid : solutions) {
+            in.read(reinterpret_cast<char*>(grid.data()), sizeof(uint32_t) * 9);
+        }
+    }
+    if (!in) return false;
+    *this = move(loaded);
+    return true;
+}
+
+bool SweepState::save(const string& path) const {
+    // Write next to the target and rename, so an interrupted save keeps the previous state.
+    string temporary = path + ".tmp";
+    {
+        ofstream out(temporary, ios::binary | ios::trunc);
+        auto writeU32 = [&](uint32_t value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        out.write("SQSWEEP2", 8);
+        writeU32(uint32_t(puzzle.requiredDigits.size()));
+        out.write(puzzle.requiredDigits.data(), puzzle.requiredDigits.size());
+        for (const ColumnMasks& masks : puzzle.rowMasks) {
+            out.write(reinterpret_cast<const char*>(masks.data()), sizeof(uint16_t) * 9);
+        }
+        writeU32(low);
+        writeU32(uint32_t(statuses.size()));
+        out.write(reinterpret_cast<const char*>(statuses.data()), statuses.size());
+        writeU32(uint32_t(solutionsByGcd.size()));
+        for (const auto& entry : solutionsByGcd) {
+            writeU32(entry.first);
+            writeU32(uint32_t(entry.second.size()));
+            for (const array<uint32_t, 9>& grid : entry.second) {
+                out.write(reinterpret_cast<const char*>(grid.data()), sizeof(uint32_t) * 9);
+            }
+        }
+        if (!out) return false;
+    }
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+//--------------------------------------------------------------------
+// Result cache
+//--------------------------------------------------------------------
+
+const char* const SOLVER_VERSION = "2025.2";
+
+uint64_t puzzleHash(const PuzzleDefinition& puzzle) {
+    // FNV-1a over the version, the sorted required digits and the 81 masks.
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    for (const char* c = SOLVER_VERSION; *c; c++) {
+        mix(uint8_t(*c));
+    }
+    uint16_t required = 0;
+    for (char d : puzzle.requiredDigits) {
+        required |= uint16_t(1 << (d - '0'));
+    }
+    mix(required);
+    for (const ColumnMasks& masks : puzzle.rowMasks) {
+        for (uint16_t mask : masks) {
+            mix(mask);
+        }
+    }
+    return hash;
+}
+
+string ResultCache::path(const PuzzleDefinition& puzzle) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.sqs", (unsigned long long)puzzleHash(puzzle));
+    return directory + "/" + name;
+}
+
+// Text layout, one field per line: "sqs-result VERSION", searched-from, frontier, best-gcd,
+// complete, then a "solution" line of 9 row values per solution.
+bool ResultCache::lookup(const PuzzleDefinition& puzzle, CachedResult& result) const {
+    ifstream in(path(puzzle));
+    string field, version;
+    if (!(in >> field >> version) || field != "sqs-result" || version != SOLVER_VERSION) return false;
+    CachedResult loaded;
+    int complete = 0;
+    if (!(in >> field >> loaded.searchedFrom >> field >> loaded.frontier >> field >> loaded.bestGCD
+             >> field >> complete)) {
+        return false;
+    }
+    loaded.complete = complete != 0;
+    while (in >> field && field == "solution") {
+        array<uint32_t, 9> grid;
+        for (uint32_t& row : grid) {
+            if (!(in >> row)) return false;
+        }
+        loaded.solutions.push_back(grid);
+    }
+    result = move(loaded);
+    return true;
+}
+
+bool ResultCache::store(const PuzzleDefinition& puzzle, const CachedResult& result) const {
+    // Write next to the target and rename, so concurrent readers only ever see whole files.
+    string target = path(puzzle);
+    string temporary = target + "." + to_string(random_device()()) + ".tmp";
+    {
+        ofstream out(temporary, ios::trunc);
+        out << "sqs-result " << SOLVER_VERSION << "\n"
+            << "searched-from " << result.searchedFrom << "\n"
+            << "frontier " << result.frontier << "\n"
+            << "best-gcd " << result.bestGCD << "\n"
+            << "complete " << (result.complete ? 1 : 0) << "\n";
+        for (const array<uint32_t, 9>& grid : result.solutions) {
+            out << "solution";
+            for (uint32_t row : grid) {
+                out << " " << row;
+            }
+            out << "\n";
+        }
+        if (!out) return false;
+    }
+    return rename(temporary.c_str(), target.c_str()) == 0;
+}
+
+//--------------------------------------------------------------------
+// Latency histograms
+//--------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram(int subBits) : subBits(subBits), counts(size_t(65 - subBits) << subBits, 0) {}
+
+// Values below 2^subBits map to themselves. A larger value with its top bit at position
+// subBits + shift keeps its leading subBits + 1 bits, giving bucket (shift + 1) << subBits
+// plus the bits below the leading one.
+size_t LatencyHistogram::bucket(uint64_t value) const {
+    uint64_t exact = uint64_t(1) << subBits;
+    if (value < exact) {
+        return size_t(value);
+    }
+    int shift = 63 - __builtin_clzll(value) - subBits;
+    return (size_t(shift + 1) << subBits) + size_t((value >> shift) - exact);
+}
+
+uint64_t LatencyHistogram::bucketHigh(size_t index) const {
+    uint64_t exact = uint64_t(1) << subBits;
+    if (index < exact) {
+        return index;
+    }
+    int shift = int(index >> subBits) - 1;
+    uint64_t leading = (index & (exact - 1)) + exact;
+    return shift + subBits >= 63 ? UINT64_MAX : ((leading + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucket(value)]++;
+    minimum = total ? std::min(minimum, value) : value;
+    maximum = std::max(maximum, value);
+    sum += double(value);
+    total++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.subBits != subBits) {
+        return;
+    }
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    if (other.total) {
+        minimum = total ? std::min(minimum, other.minimum) : other.minimum;
+        maximum = std::max(maximum, other.maximum);
+    }
+    sum += other.sum;
+    total += other.total;
+}
+
+void LatencyHistogram::reset() {
+    fill(counts.begin(), counts.end(), 0);
+    total = minimum = maximum = 0;
+    sum = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(ceil(p / 100 * double(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketHigh(i), maximum);
+        }
+    }
+    return maximum;
+}
+
+//--------------------------------------------------------------------
+// Engine
+//--------------------------------------------------------------------
+
+struct Engine::Impl {
+    EngineConfig config;
+    const KernelSet* kernels;
+    string kernelName;
+    string kernelReport;
+    
+    // Stage 1: generated numbers, as values for the digit-table kernel.
+    vector<char> requiredDigits;
+    vector<uint32_t> numbers;
+    GenerationStats generation;
+    bool generated = false;
+    
+    // Stage 2: each row's masks and the numeric values of its base candidates.
+    array<ColumnMasks, 9> rowMasks;
+    array<bool, 9> rowFiltered = {};
+    array<vector<uint32_t>, 9> rowValues;
+    
+    // Stage 3: indices of the base candidates divisible by instanceGCD (0 when there is no instance).
+    array<vector<uint32_t>, 9> divisibleIndices;
+    array<size_t, 9> divisibleCounts = {};
+    uint32_t instanceGCD = 0;
+    
+    // NUMA nodes for replicated searches, read on first use.
+    vector<NumaNode> numaNodes;
+    bool numaDetected = false;
+    
+    // Scheduling counters of the parallel stages.
+    PoolTelemetry telemetry;
+    
+    // Per-GCD stage costs of Engine::search.
+    StageHistograms histograms;
+    
+    // Running totals of Engine::search and the running solve's progress; nodes in counters
+    // only include finished solves. The lock keeps a snapshot consistent across the two.
+    SearchCounters counters;
+    SearchProgress progress;
+    mutable mutex countersLock;
+    
+    // The rows of stage 2 split by the digit they leave out, for the digit engine; built on
+    // first use and cleared with the rows.
+    vector<GcdInstance> baseInstances;
+    
+    // Filters every row by gcd; returns the first row left empty, or -1 if none is.
+    int filterDivisible(uint32_t gcd);
+    // Stage 4 on the pass over the candidates that leave out missing.
+    SolveResult solveInstance(GcdInstance& instance, int missing, bool baseRows, SearchProgress* progress);
+};
+
+Engine::Engine(const EngineConfig& config) : impl(new Impl) {
+    impl->config = config;
+    impl->kernels = &selectKernels(config.kernels, impl->kernelReport);
+    impl->telemetry.tracing = config.traceWorkers;
+    impl->kernelName = impl->kernels->name;
+}
+
+Engine::~Engine() = default;
+
+const EngineConfig& Engine::config() const {
+    return impl->config;
+}
+
+const string& Engine::kernelSet() const {
+    return impl->kernelName;
+}
+
+const string& Engine::kernelReport() const {
+    return impl->kernelReport;
+}
+
+SearchCounters Engine::searchCounters() const {
+    lock_guard<mutex> guard(impl->countersLock);
+    SearchCounters counters = impl->counters;
+    counters.nodes += impl->progress.candidateTries.load();
+    return counters;
+}
+
+const StageHistograms& Engine::stageHistograms() const {
+    return impl->histograms;
+}
+
+vector<WorkerTelemetry> Engine::workerTelemetry() const {
+    return impl->telemetry.snapshot();
+}
+
+bool Engine::writeTrace(const string& path) const {
+    return impl->telemetry.writeTrace(path);
+}
+
+GenerationStats Engine::generate(const vector<char>& requiredDigits, unsigned numThreads) {
+    if (impl->generated && requiredDigits == impl->requiredDigits) {
+        GenerationStats stats = impl->generation;
+        stats.milliseconds = 0;
+        stats.reused = true;
+        return stats;
+    }
+    PhaseScope phase(PHASE_GENERATION);
+    GenerationStats stats;
+    vector<uint32_t>& validNumbers = impl->numbers;
+    validNumbers.clear();
+    impl->rowFiltered.fill(false);
+    impl->instanceGCD = 0;
+    impl->baseInstances.clear();
+    
+    // Start timing for performance measurement
+    auto startGenTime = chrono::steady_clock::now();
+    
+    // One task per skipped digit and leading digit: the permutations of the other eight digits.
+    // Each task fills its own list; they are merged in task order once all are done, which is
+    // the lexicographic order of a single pass, so the base rows (and every search over them)
+    // don't depend on which worker runs which task.
+    struct Block {
+        char skipDigit;
+        char leadDigit;
+        vector<uint32_t> numbers;
+        size_t permutations = 0;
+    };
+    vector<Block> blocks;
+    stats.digits.resize(10);
+    
+    // Try skipping each digit (0-9) one at a time
+    for (char skipDigit = '0'; skipDigit <= '9'; skipDigit++) {
+        GenerationStats::Digit& digitStats = stats.digits[skipDigit - '0'];
+        digitStats = {skipDigit, false, 0, 0};
+        
+        // Skip this iteration if the digit we want to skip is a required digit
+        if (find(requiredDigits.begin(), requiredDigits.end(), skipDigit) != requiredDigits.end()) {
+            digitStats.skipped = true;
+            continue;
+        }
+        for (char leadDigit = '0'; leadDigit <= '9'; leadDigit++) {
+            if (leadDigit != skipDigit) {
+                blocks.push_back({skipDigit, leadDigit, {}, 0});
+            }
+        }
+    }
+    
+    auto runBlock = [&](size_t b) {
+        PhaseScope phase(PHASE_GENERATION);
+        Block& block = blocks[b];
+        SUDOKU_PROBE2(generation__block__start, int(block.skipDigit - '0'), int(block.leadDigit - '0'));
+        // Create a string with the lead digit followed by the rest, sorted for permutation
+        string digits(1, block.leadDigit);
+        for (char d = '0'; d <= '9'; d++) {
+            if (d != block.skipDigit && d != block.leadDigit) {
+                digits.push_back(d);
+            }
+        }
+        
+        // Every permutation has the required digits, as only a non-required digit is skipped;
+        // the row filter's digit tables check them again along with the clue masks.
+        do {
+            block.numbers.push_back(numberValue(digits));
+            block.permutations++;
+        } while (next_permutation(digits.begin() + 1, digits.end()));
+        SUDOKU_PROBE3(generation__block__end, int(block.skipDigit - '0'), int(block.leadDigit - '0'),
+                      block.numbers.size());
+    };
+    auto blockLabel = [&](size_t b) {
+        return string("skip ") + blocks[b].skipDigit + ", lead " + blocks[b].leadDigit;
+    };
+    SUDOKU_PROBE2(generation__start, requiredDigits.size(), blocks.size());
+    runPool("generation", int(max(1u, numThreads)), blocks.size(), runBlock, blockLabel, &impl->telemetry);
+    
+    for (Block& block : blocks) {
+        GenerationStats::Digit& digitStats = stats.digits[block.skipDigit - '0'];
+        digitStats.validStrings += block.numbers.size();
+        digitStats.permutations += block.permutations;
+        validNumbers.insert(validNumbers.end(), block.numbers.begin(), block.numbers.end());
+    }
+    for (const GenerationStats::Digit& digit : stats.digits) {
+        if (!digit.skipped) {
+            SUDOKU_PROBE3(generation__digit, int(digit.skipDigit - '0'), digit.validStrings, digit.permutations);
+        }
+    }
+    
+    auto endGenTime = chrono::steady_clock::now();
+    stats.milliseconds = chrono::duration_cast<chrono::milliseconds>(endGenTime - startGenTime).count();
+    stats.total = validNumbers.size();
+    SUDOKU_PROBE2(generation__end, stats.total, stats.milliseconds);
+    impl->requiredDigits = requiredDigits;
+    impl->generation = stats;
+    impl->generated = true;
+    return stats;
+}
+
+size_t Engine::numberCount() const {
+    return impl->numbers.size();
+}
+
+unsigned Engine::filterRows(const array<ColumnMasks, 9>& givenMasks) {
+    PhaseScope phase(PHASE_ROW_FILTER);
+    vector<uint32_t> keptIndices(impl->numbers.size());
+    uint32_t requiredMask = 0;
+    for (char d : impl->requiredDigits) {
+        requiredMask |= 1u << (d - '0');
+    }
+    // Clues that contradict each other leave no grid either way; their masks are kept as given.
+    array<ColumnMasks, 9> rowMasks = givenMasks;
+    if (propagateClues(rowMasks, uint16_t(requiredMask)) < 0) {
+        rowMasks = givenMasks;
+    }
+    unique_ptr<DigitTables> tables(new DigitTables);
+    unsigned changedRows = 0;
+    for (int r = 0; r < 9; r++) {
+        if (impl->rowFiltered[r] && impl->rowMasks[r] == rowMasks[r]) continue;
+        changedRows |= 1u << r;
+        impl->rowMasks[r] = rowMasks[r];
+        impl->rowFiltered[r] = true;
+        buildDigitTables(rowMasks[r].data(), requiredMask, *tables);
+        size_t kept = impl->kernels->filterDigitTables(impl->numbers.data(), impl->numbers.size(), *tables,
+                                                       keptIndices.data());
+        impl->rowValues[r].clear();
+        impl->rowValues[r].reserve(kept);
+        for (size_t i = 0; i < kept; i++) {
+            impl->rowValues[r].push_back(impl->numbers[keptIndices[i]]);
+        }
+        // Index buffers for the divisibility kernel, sized once and reused for every GCD.
+        impl->divisibleIndices[r].resize(kept);
+        SUDOKU_PROBE2(row__filter__done, r, kept);
+    }
+    if (changedRows) {
+        impl->instanceGCD = 0;
+        impl->baseInstances.clear();
+    }
+    return changedRows;
+}
+
+size_t Engine::rowSize(int row) const {
+    return impl->rowValues[row].size();
+}
+
+size_t Engine::copyRowValues(int row, uint32_t* out, size_t capacity) const {
+    const vector<uint32_t>& values = impl->rowValues[row];
+    copy_n(values.begin(), min(capacity, values.size()), out);
+    return values.size();
+}
+
+vector<uint32_t> Engine::invariantExclusions() const {
+    // A row's value is congruent mod 9 to its digit sum, 45 minus its missing digit, and mod 11
+    // to its alternating digit sum, which the clues fix through the digits allowed in odd and
+    // even columns. Both show in the value mod 99, so residue sets mod 99 decide them all. All
+    // nine rows of a grid miss the same digit (solve searches one at a time), so the sets are
+    // kept per missing digit: a divisor is ruled out when, for every missing digit, some row
+    // has no candidate it divides.
+    vector<array<array<bool, 99>, 9>> residues(10);
+    for (int r = 0; r < 9; r++) {
+        for (uint32_t value : impl->rowValues[r]) {
+            residues[missingDigit(value)][r][value % 99] = true;
+        }
+    }
+    vector<uint32_t> excluded;
+    for (uint32_t q : {3u, 9u, 11u, 33u, 99u}) {
+        bool implied = false;
+        for (uint32_t e : excluded) implied = implied || q % e == 0;
+        if (implied) continue;
+        bool possible = false;
+        for (int missing = 0; missing < 10 && !possible; missing++) {
+            bool everyRow = true;
+            for (int r = 0; r < 9 && everyRow; r++) {
+                bool divisible = false;
+                for (uint32_t residue = 0; residue < 99 && !divisible; residue += q) {
+                    divisible = residues[missing][r][residue];
+                }
+                everyRow = divisible;
+            }
+            possible = everyRow;
+        }
+        if (!possible) excluded.push_back(q);
+    }
+    return excluded;
+}
+
+int Engine::Impl::filterDivisible(uint32_t gcd) {
+    PhaseScope phase(PHASE_DIVISIBILITY);
+    instanceGCD = 0;
+    for (int r = 0; r < 9; r++) {
+        divisibleCounts[r] = kernels->filterDivisible(rowValues[r].data(), rowValues[r].size(),
+                                                      gcd, divisibleIndices[r].data());
+        if (divisibleCounts[r] == 0) {
+            return r;
+        }
+    }
+    instanceGCD = gcd;
+    return -1;
+}
+
+bool Engine::writeRowTables(const string& path) const {
+    ofstream out(path);
+    out << "// Generated by SudokuSolver+ --emit-tables; do not edit.\n"
+        << "// Base row candidates of one puzzle, compiled in with -DSUDOKU_EMBEDDED_TABLES.\n"
+        << "namespace embedded {\n\n"
+        << "const char REQUIRED_DIGITS[] = \"" << string(impl->requiredDigits.begin(), impl->requiredDigits.end()) << "\";\n\n"
+        << "const ColumnMasks ROW_MASKS[9] = {\n";
+    for (const ColumnMasks& masks : impl->rowMasks) {
+        out << "    {{";
+        for (int c = 0; c < 9; c++) {
+            out << (c ? ", " : "") << "0x" << hex << masks[c] << dec;
+        }
+        out << "}},\n";
+    }
+    out << "};\n\nconst uint32_t ROW_SIZES[9] = {";
+    for (int r = 0; r < 9; r++) {
+        out << (r ? ", " : "") << impl->rowValues[r].size();
+    }
+    out << "};\n\nconst uint32_t ROW_VALUES[] = {\n";
+    for (const vector<uint32_t>& values : impl->rowValues) {
+        for (size_t i = 0; i < values.size(); i++) {
+            out << (i % 8 == 0 ? "    " : " ") << values[i] << (i % 8 == 7 ? ",\n" : ",");
+        }
+        if (values.size() % 8) out << "\n";
+    }
+    out << "};\n\n} // namespace embedded\n";
+    return bool(out);
+}
+
+#ifdef SUDOKU_EMBEDDED_TABLES
+#include "SudokuTables.inc"
+#endif
+
+bool Engine::loadEmbeddedRows(const PuzzleDefinition& puzzle) {
+#ifdef SUDOKU_EMBEDDED_TABLES
+    if (puzzle.requiredDigits != vector<char>(embedded::REQUIRED_DIGITS, embedded::REQUIRED_DIGITS + strlen(embedded::REQUIRED_DIGITS))) {
+        return false;
+    }
+    for (int r = 0; r < 9; r++) {
+        if (puzzle.rowMasks[r] != embedded::ROW_MASKS[r]) return false;
+    }
+    const uint32_t* values = embedded::ROW_VALUES;
+    for (int r = 0; r < 9; r++) {
+        impl->rowValues[r].assign(values, values + embedded::ROW_SIZES[r]);
+        impl->divisibleIndices[r].resize(embedded::ROW_SIZES[r]);
+        impl->rowMasks[r] = puzzle.rowMasks[r];
+        impl->rowFiltered[r] = true;
+        values += embedded::ROW_SIZES[r];
+    }
+    impl->requiredDigits = puzzle.requiredDigits;
+    impl->numbers.clear();
+    impl->generated = false;
+    impl->instanceGCD = 0;
+    impl->baseInstances.clear();
+    return true;
+#else
+    (void)puzzle;
+    return false;
+#endif
+}
+
+bool Engine::filterDivisible(uint32_t gcd) {
+    return impl->filterDivisible(gcd) < 0;
+}
+
+size_t Engine::divisibleCount(int row) const {
+    return impl->instanceGCD ? impl->divisibleCounts[row] : 0;
+}
+
+size_t Engine::copyDivisibleValues(int row, uint32_t* out, size_t capacity) const {
+    size_t count = divisibleCount(row);
+    for (size_t i = 0; i < min(capacity, count); i++) {
+        out[i] = impl->rowValues[row][impl->divisibleIndices[row][i]];
+    }
+    return count;
+}
+
+namespace {
+
+// The digit engine replaces stage 3: it searches the base rows and prunes by row residues.
+bool searchesBaseRows(const EngineConfig& options) {
+    return options.engine == "digits" && !options.portfolio && options.restartUnit == 0;
+}
+
+} // namespace
+
+SolveResult Engine::Impl::solveInstance(GcdInstance& instance, int missing, bool baseRows, SearchProgress* progress) {
+    SolveResult result;
+    const EngineConfig& options = config;
+    const KernelSet& kernels = *this->kernels;
+    int candidateGCD = int(instanceGCD);
+    string label = "GCD " + to_string(candidateGCD) + " (rows without " + to_string(missing) + ")";
+    
+    // Order each row's candidates; the cost is reported with the search statistics.
+    PhaseScope phase(PHASE_ORDERING);
+    if (!baseRows && (options.valueOrder == "lcv" || options.portfolio)) {
+        auto startOrderTime = chrono::steady_clock::now();
+        orderLeastConstraining(instance);
+        result.orderingMicros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startOrderTime).count();
+    }
+    
+    if (!options.dimacsDir.empty() && !baseRows) {
+        string path = options.dimacsDir + "/gcd" + to_string(candidateGCD) + "-without" + to_string(missing) + ".cnf";
+        if (!writeDimacs(encodeInstance(instance), instance, path)) {
+            result.summary = "Could not write " + path + ".";
+        }
+    }
+    
+    // We'll use a fixed ordering based on our candidate counts.
+    vector<int> rowOrder = { 1, 8, 5, 3, 6, 7, 2, 0, 4 }; // 0-indexed row indices
+    phase.set(PHASE_OTHER);
+    
+    auto startSolverTime = chrono::steady_clock::now();
+    
+    // Per-node copies of the instance for the parallel searches.
+    InstanceReplicas replicas;
+    bool parallel = options.portfolio || options.restartUnit > 0;
+    if (options.numaReplicate && parallel) {
+        if (!numaDetected) {
+            numaNodes = detectNumaNodes();
+            numaDetected = true;
+        }
+        replicas = replicateInstance(instance, numaNodes);
+    }
+    const InstanceReplicas* placement = replicas.copies.empty() ? nullptr : &replicas;
+    
+    vector<vector<vector<int>>> allSolutions;
+    ostringstream summary;
+    if (options.portfolio) {
+        // Race the solver configurations; the winner's answer is definitive.
+        PortfolioResult raced = solvePortfolio(instance, kernels, rowOrder, options.firstSolution,
+                                               options.restartUnit > 0 ? options.restartUnit : 100000,
+                                               options.seed, progress, options.deterministic, placement,
+                                               &telemetry);
+        result.candidateTries = raced.candidateTries;
+        allSolutions = move(raced.solutions);
+        result.exhausted = !options.firstSolution || allSolutions.empty();
+        result.winner = raced.winner;
+        result.winnerSeconds = raced.winnerSeconds;
+        summary << "Portfolio for " << label << " won by " << raced.winner
+                << " in " << raced.winnerSeconds << " s.";
+    } else if (options.restartUnit > 0) {
+        // Randomized first-solution search with Luby restarts, optionally raced by several workers.
+        RestartResult restart = options.deterministic
+            ? solveWithRestartsInRounds(instance, kernels, options.restartUnit, options.restartWorkers, options.seed,
+                                        progress, placement, &telemetry)
+            : solveWithRestarts(instance, kernels, options.restartUnit, options.restartWorkers, options.seed,
+                                progress, nullptr, placement, &telemetry);
+        result.candidateTries = restart.candidateTries;
+        result.exhausted = restart.exhausted;
+        if (restart.found) {
+            allSolutions.push_back(restart.solution);
+        }
+        summary << "Randomized search for " << label << ": " << restart.runs << " run(s) on "
+                << options.restartWorkers << " worker(s), "
+                << (restart.found ? "witness" : "exhaustive proof") << " from worker " << restart.winningWorker
+                << ".";
+    } else if (options.engine == "sat") {
+        // CNF encoding solved by the built-in CDCL solver.
+        SatRowSolver solver(instance);
+        solver.firstSolution = options.firstSolution;
+        solver.progress = progress;
+        solver.run();
+        result.candidateTries = solver.candidateTries;
+        result.exhausted = solver.exhausted;
+        allSolutions = move(solver.solutions);
+        summary << "SAT engine for " << label << ": " << solver.numVariables << " variables, "
+                << solver.numClauses << " clauses, " << solver.conflicts << " conflicts, "
+                << solver.candidateTries << " decisions.";
+    } else if (options.engine == "clique" && cliqueAdjacencyBytes(instance) <= CLIQUE_MAX_ADJACENCY_BYTES) {
+        // Bit-parallel clique search over the candidate compatibility graph.
+        CliqueRowSolver solver(instance);
+        solver.firstSolution = options.firstSolution;
+        solver.progress = progress;
+        solver.run();
+        result.candidateTries = solver.candidateTries;
+        result.exhausted = solver.exhausted;
+        allSolutions = move(solver.solutions);
+    } else if (options.engine == "digits") {
+        // Digit-at-a-time placement with every row's residue modulo the GCD tracked.
+        DigitPlacementSolver solver(instance, uint32_t(candidateGCD));
+        solver.firstSolution = options.firstSolution;
+        solver.progress = progress;
+        solver.run();
+        result.candidateTries = solver.candidateTries;
+        result.exhausted = solver.exhausted;
+        allSolutions = move(solver.solutions);
+    } else {
+        if (options.engine == "clique") {
+            summary << "Clique engine for " << label << ": the adjacency would take "
+                    << (cliqueAdjacencyBytes(instance) >> 20) << " MiB, backtracking instead.";
+        }
+        // Recursive backtracking using the fixed ordering.
+        RowSolver solver(instance, kernels, rowOrder);
+        solver.firstSolution = options.firstSolution;
+        solver.progress = progress;
+        solver.run();
+        result.candidateTries = solver.candidateTries;
+        result.exhausted = solver.exhausted;
+        allSolutions = move(solver.solutions);
+    }
+    
+    result.solverNanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startSolverTime).count();
+    
+    if (options.numaReplicate && parallel) {
+        int workers = options.portfolio ? int(portfolioConfigs(options.firstSolution).size()) : options.restartWorkers;
+        summary << (summary.tellp() > 0 ? "\n" : "") << numaReport(replicas, instance, workers);
+    }
+    if (!instance.rowSymmetries.empty()) {
+        // Only orbit representatives were searched; list every solution again.
+        if (!options.firstSolution) {
+            allSolutions = expandSymmetricSolutions(allSolutions, instance.rowSymmetries);
+        }
+        summary << (summary.tellp() > 0 ? "\n" : "") << "Symmetry breaking for " << label << ": "
+                << instance.rowSymmetries.size() << " row permutation(s) leave the instance unchanged.";
+    }
+    for (const auto& grid : allSolutions) {
+        result.solutions.push_back(packGrid(grid));
+    }
+    string engineSummary = summary.str();
+    if (!engineSummary.empty()) {
+        result.summary += (result.summary.empty() ? "" : "\n") + engineSummary;
+    }
+    return result;
+}
+
+SolveResult Engine::solve(SearchProgress* progressOut) {
+    SolveResult result;
+    if (impl->instanceGCD == 0) {
+        return result;
+    }
+    const EngineConfig& options = impl->config;
+    SearchProgress ownProgress;
+    SearchProgress* progress = progressOut ? progressOut : &ownProgress;
+    
+    // All nine rows of a grid leave out the same digit, which the engines don't check on their
+    // own, so each digit gets a pass over the candidates that leave it out. The digit engine
+    // does its own divisibility pruning and searches the base rows, split once; the others
+    // search the divisible candidates.
+    bool baseRows = searchesBaseRows(options);
+    array<vector<uint32_t>, 9> all;
+    array<size_t, 9> allCounts;
+    if (baseRows && impl->baseInstances.empty()) {
+        for (int r = 0; r < 9; r++) {
+            allCounts[r] = impl->rowValues[r].size();
+            all[r].resize(allCounts[r]);
+            for (size_t i = 0; i < allCounts[r]; i++) all[r][i] = uint32_t(i);
+        }
+    }
+    result.exhausted = true;
+    for (int missing = 0; missing < 10; missing++) {
+        // Convert the pass's candidates to vectors of digits and conflict bits. Interchangeable
+        // rows are detected while the rows are still in generation order.
+        PhaseScope phase(PHASE_CONVERSION);
+        auto startConversionTime = chrono::steady_clock::now();
+        GcdInstance filtered;
+        if (!baseRows) {
+            filtered = buildMissingDigitInstance(int(impl->instanceGCD), missing, impl->rowValues,
+                                                 impl->divisibleIndices, impl->divisibleCounts);
+            if (options.symmetryBreaking) {
+                filtered.rowSymmetries = instanceRowSymmetries(filtered);
+            }
+        } else if (impl->baseInstances.size() == size_t(missing)) {
+            impl->baseInstances.push_back(buildMissingDigitInstance(0, missing, impl->rowValues, all, allCounts));
+            if (options.symmetryBreaking) {
+                impl->baseInstances.back().rowSymmetries = instanceRowSymmetries(impl->baseInstances.back());
+            }
+        }
+        GcdInstance& instance = baseRows ? impl->baseInstances[missing] : filtered;
+        result.conversionNanos += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startConversionTime).count();
+        bool emptyRow = false;
+        for (int r = 0; r < 9; r++) {
+            emptyRow = emptyRow || instance.candidates[r].empty();
+        }
+        if (emptyRow) {
+            continue;
+        }
+        
+        SolveResult pass = impl->solveInstance(instance, missing, baseRows, progress);
+        result.solutions.insert(result.solutions.end(), pass.solutions.begin(), pass.solutions.end());
+        result.exhausted = result.exhausted && pass.exhausted;
+        result.candidateTries += pass.candidateTries;
+        result.orderingMicros += pass.orderingMicros;
+        result.solverNanos += pass.solverNanos;
+        if (!pass.winner.empty()) {
+            result.winner = pass.winner;
+            result.winnerSeconds = pass.winnerSeconds;
+        }
+        if (!pass.summary.empty()) {
+            result.summary += (result.summary.empty() ? "" : "\n") + pass.summary;
+        }
+        if (options.firstSolution && !result.solutions.empty()) {
+            break;
+        }
+    }
+    return result;
+}
+
+SearchOutcome Engine::search(const vector<uint32_t>& gcds, SearchObserver* observer, SweepState* state) {
+    SearchOutcome outcome;
+    if (state) {
+        PuzzleDefinition current;
+        current.requiredDigits = impl->requiredDigits;
+        current.rowMasks = impl->rowMasks;
+        state->rebase(current);
+    }
+    for (uint32_t gcd : gcds) {
+        SweepState::Status known = state ? state->status(gcd) : SweepState::UNKNOWN;
+        if (known == SweepState::WITNESSED && !impl->config.firstSolution) {
+            known = SweepState::UNKNOWN;    // enumeration needs the full solution set
+        }
+        if (known == SweepState::FEASIBLE || known == SweepState::WITNESSED) {
+            outcome.found = outcome.reused = true;
+            outcome.gcd = gcd;
+            outcome.result.solutions = *state->solutions(gcd);
+            outcome.result.exhausted = known == SweepState::FEASIBLE;
+            break;
+        }
+        if (known != SweepState::UNKNOWN) {
+            outcome.reusedResults++;
+            lock_guard<mutex> guard(impl->countersLock);
+            impl->counters.reused++;
+            continue;
+        }
+        {
+            lock_guard<mutex> guard(impl->countersLock);
+            impl->counters.currentGCD = gcd;
+            impl->counters.gcdsExamined++;
+        }
+        auto startFilterTime = chrono::steady_clock::now();
+        int emptyRow = -1;
+        if (searchesBaseRows(impl->config)) {
+            impl->instanceGCD = gcd;
+        } else {
+            emptyRow = impl->filterDivisible(gcd);
+        }
+        SUDOKU_PROBE2(gcd__filter, gcd, emptyRow);
+        impl->histograms.filterNanos.record(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startFilterTime).count());
+        if (emptyRow >= 0) {
+            {
+                lock_guard<mutex> guard(impl->countersLock);
+                impl->counters.emptyRow[emptyRow]++;
+            }
+            if (state) state->record(gcd, SweepState::Status(SweepState::EMPTY_ROW + emptyRow));
+            if (observer) observer->gcdExamined(gcd);
+            continue;
+        }
+        SearchProgress& progress = impl->progress;
+        if (observer) observer->solveStarted(gcd, progress);
+        SUDOKU_PROBE1(solve__start, gcd);
+        SolveResult result = solve(&progress);
+        SUDOKU_PROBE4(solve__end, gcd, result.candidateTries, result.solutions.size(), result.exhausted);
+        impl->histograms.conversionNanos.record(result.conversionNanos);
+        impl->histograms.solverNanos.record(result.solverNanos);
+        impl->histograms.nodes.record(result.candidateTries);
+        if (observer) observer->solveFinished(gcd, result);
+        {
+            // Solvers may publish their progress in batches; never let the total go backwards.
+            lock_guard<mutex> guard(impl->countersLock);
+            impl->counters.solved++;
+            impl->counters.infeasible += result.solutions.empty() && result.exhausted;
+            impl->counters.nodes += max(result.candidateTries, progress.candidateTries.load());
+            progress.candidateTries = 0;
+        }
+        if (observer) observer->gcdExamined(gcd);
+        if (state && (!result.solutions.empty() || result.exhausted)) {
+            SweepState::Status status = result.solutions.empty() ? SweepState::INFEASIBLE
+                                      : result.exhausted ? SweepState::FEASIBLE : SweepState::WITNESSED;
+            state->record(gcd, status, result.solutions);
+        }
+        if (!result.solutions.empty()) {
+            SUDOKU_PROBE2(solution__found, gcd, result.solutions.front()[4]);
+            outcome.found = true;
+            outcome.gcd = gcd;
+            outcome.result = move(result);
+            break;
+        }
+    }
+    lock_guard<mutex> guard(impl->countersLock);
+    impl->counters.currentGCD = 0;
+    return outcome;
+}
+
+//--------------------------------------------------------------------
+// Synthetic puzzles
+//--------------------------------------------------------------------
+
+const unsigned long long PLANTING_BUDGET = 50000000;   // candidate tries per digit set
+const unsigned long long PLANTING_RESTART_UNIT = 10000;
+
+bool generateSyntheticPuzzle(uint32_t gcd, double givenDensity, double disallowDensity, uint64_t seed,
+                             SyntheticPuzzle& out) {
+    mt19937_64 rng(seed);
+    array<int, 10> missingOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    shuffle(missingOrder.begin(), missingOrder.end(), rng);
+    
+    // Randomized first-solution runs with a Luby schedule on each instance, within a budget
+    // so that a digit set without a grid doesn't have to be proven empty.
+    string report;
+    const KernelSet& kernels = selectKernels("auto", report);
+    array<ColumnMasks, 9> open;
+    for (ColumnMasks& masks : open) {
+        masks.fill(ALL_DIGITS_MASK);
+    }
+    array<uint32_t, 9> grid = {};
+    bool planted = false;
+    for (int missing : missingOrder) {
+        vector<char> digits;
+        for (char d = '0'; d <= '9'; d++) {
+            if (d != '0' + missing) digits.push_back(d);
+        }
+        Engine engine;
+        engine.generate(digits, 1);
+        engine.filterRows(open);
+        if (!engine.filterDivisible(gcd)) {
+            continue;
+        }
+        array<vector<uint32_t>, 9> values, indices;
+        array<size_t, 9> counts;
+        for (int r = 0; r < 9; r++) {
+            counts[r] = engine.divisibleCount(r);
+            values[r].resize(counts[r]);
+            engine.copyDivisibleValues(r, values[r].data(), counts[r]);
+            indices[r].resize(counts[r]);
+            for (size_t i = 0; i < counts[r]; i++) indices[r][i] = uint32_t(i);
+        }
+        GcdInstance instance = buildInstance(int(gcd), values, indices, counts);
+        // A run must at least be able to scan the rows once.
+        unsigned long long unit = PLANTING_RESTART_UNIT;
+        for (int r = 0; r < 9; r++) unit = max<unsigned long long>(unit, 4 * counts[r]);
+        unsigned long long spent = 0;
+        for (unsigned long long run = 1; spent < PLANTING_BUDGET && !planted; run++) {
+            RestartRun attempt = randomizedRun(instance, kernels, rng, lubyTerm(run) * unit, nullptr, nullptr);
+            spent += attempt.candidateTries;
+            if (attempt.found) {
+                for (int r = 0; r < 9; r++) {
+                    for (int d : attempt.solution[r]) grid[r] = grid[r] * 10 + uint32_t(d);
+                }
+                planted = true;
+            }
+            if (attempt.exhausted) break;
+        }
+        if (planted) break;
+    }
+    if (!planted) {
+        return false;
+    }
+    
+    // A random validity-preserving row permutation: bands, and rows within each band.
+    array<int, 3> bands = {0, 1, 2};
+    shuffle(bands.begin(), bands.end(), rng);
+    array<uint32_t, 9> permuted;
+    for (int b = 0; b < 3; b++) {
+        array<int, 3> rows = {0, 1, 2};
+        shuffle(rows.begin(), rows.end(), rng);
+        for (int i = 0; i < 3; i++) {
+            permuted[3 * b + i] = grid[3 * bands[b] + rows[i]];
+        }
+    }
+    
+    SyntheticPuzzle synthetic;
+    synthetic.planted = permuted;
+    synthetic.plantedGCD = 0;
+    for (uint32_t row : permuted) {
+        uint32_t a = synthetic.plantedGCD, b = row;
+        while (b) {
+            uint32_t t = a % b;
+            a = b;
+            b = t;
+        }
+        synthetic.plantedGCD = a;
+    }
+    
+    // Clues on a random selection of cells; givens first, then disallowed cells.
+    vector<int> cells(81);
+    for (int i = 0; i < 81; i++) cells[i] = i;
+    shuffle(cells.begin(), cells.end(), rng);
+    size_t givens = min<size_t>(81, size_t(lround(givenDensity * 81)));
+    size_t disallowed = min<size_t>(81 - givens, size_t(lround(disallowDensity * 81)));
+    array<ColumnMasks, 9>& rowMasks = synthetic.puzzle.rowMasks;
+    rowMasks = open;
+    uint16_t requiredMask = 0;
+    for (size_t i = 0; i < givens + disallowed; i++) {
+        int r = cells[i] / 9, c = cells[i] % 9;
+        char digit = numberDigits(permuted[r])[c];
+        if (i < givens) {
+            requireDigit(rowMasks[r], c, digit);
+            requiredMask |= uint16_t(1 << (digit - '0'));
+            continue;
+        }
+        vector<char> others;
+        for (char d = '0'; d <= '9'; d++) {
+            if (d != digit) others.push_back(d);
+        }
+        shuffle(others.begin(), others.end(), rng);
+        for (size_t k = 1 + rng() % 3; k > 0; k--) {
+            disallowDigits(rowMasks[r], c, {others[k - 1]});
+        }
+    }
+    for (char d = '0'; d <= '9'; d++) {
+        if (requiredMask & (1 << (d - '0'))) synthetic.puzzle.requiredDigits.push_back(d);
+    }
+    synthetic.givens = givens;
+    synthetic.disallowedCells = disallowed;
+    out = synthetic;
+    return true;
+}
+
+//--------------------------------------------------------------------
+// Scaling benchmark
+//--------------------------------------------------------------------
+// Fixed inputs: the puzzle's generation, the first GCDs of the default sweep for the filter
+// stage, and instances of the first GCDs below 1100 that survive the filter, each searched
+// up to a node limit, for the backtracking stage. Bandwidth is estimated from the bytes each
+// stage's arrays are read and written, not measured with hardware counters.
+
+namespace {
+
+const size_t BENCH_FILTER_GCDS = 8192;          // strong scaling
+const size_t BENCH_FILTER_GCDS_PER_THREAD = 2048;
+const size_t BENCH_INSTANCES = 8;
+const size_t BENCH_SEARCHES = 64;               // strong scaling
+const size_t BENCH_SEARCHES_PER_THREAD = 16;
+const unsigned long long BENCH_NODE_LIMIT = 2000000;
+
+// Runs items 0..count-1 on the given number of threads, which take them from a shared
+// counter; the callback also gets the thread's id. Returns the wall time in seconds.
+double timeParallel(int threads, size_t count, const function<void(size_t, int)>& item) {
+    atomic<size_t> next{0};
+    auto startTime = chrono::steady_clock::now();
+    auto worker = [&](int id) {
+        for (size_t i = next++; i < count; i = next++) {
+            item(i, id);
+        }
+    };
+    vector<thread> pool;
+    for (int id = 1; id < threads; id++) {
+        pool.emplace_back(worker, id);
+    }
+    worker(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+} // namespace
+
+vector<ScalingPoint> runScalingBenchmark(const vector<int>& threadCounts, const PuzzleDefinition& puzzle) {
+    vector<ScalingPoint> points;
+    auto add = [&](const string& stage, bool weak, int threads, double seconds, double bytes) {
+        ScalingPoint point;
+        point.stage = stage;
+        point.weak = weak;
+        point.threads = threads;
+        point.seconds = seconds;
+        point.gigabytesPerSecond = seconds > 0 ? bytes / seconds / 1e9 : 0;
+        for (const ScalingPoint& base : points) {
+            if (base.stage == stage && base.weak == weak) {
+                double scale = double(threads) / base.threads;
+                point.speedup = (weak ? scale : 1.0) * base.seconds / seconds;
+                point.efficiency = point.speedup / scale;
+                break;
+            }
+        }
+        points.push_back(point);
+    };
+    int maxThreads = *max_element(threadCounts.begin(), threadCounts.end());
+    
+    // Generation: a fresh engine each time, so nothing is reused.
+    for (int threads : threadCounts) {
+        Engine engine;
+        auto startTime = chrono::steady_clock::now();
+        GenerationStats stats = engine.generate(puzzle.requiredDigits, unsigned(threads));
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        double bytes = 0;
+        for (const GenerationStats::Digit& digit : stats.digits) {
+            bytes += 9.0 * digit.permutations;
+        }
+        bytes += double(stats.total) * (sizeof(string) + sizeof(uint64_t));
+        add("generation", false, threads, seconds, bytes);
+    }
+    
+    // The base rows shared by the filter and backtracking stages.
+    Engine engine;
+    engine.generate(puzzle.requiredDigits, unsigned(maxThreads));
+    engine.filterRows(puzzle.rowMasks);
+    array<vector<uint32_t>, 9> rowValues;
+    size_t widest = 0;
+    for (int r = 0; r < 9; r++) {
+        rowValues[r].resize(engine.rowSize(r));
+        engine.copyRowValues(r, rowValues[r].data(), rowValues[r].size());
+        widest = max(widest, rowValues[r].size());
+    }
+    string report;
+    const KernelSet& kernels = selectKernels("auto", report);
+    
+    // Filter: every row in turn until one is left empty, as Engine::search does.
+    vector<uint32_t> gcds;
+    for (uint32_t gcd = 12345678; gcds.size() < max(BENCH_FILTER_GCDS, BENCH_FILTER_GCDS_PER_THREAD * maxThreads); gcd--) {
+        if (gcd % 2 != 0 && gcd % 5 != 0) {
+            gcds.push_back(gcd);
+        }
+    }
+    vector<vector<uint32_t>> indexBuffers(maxThreads, vector<uint32_t>(widest));
+    auto filterStage = [&](int threads, size_t count) {
+        vector<double> bytes(threads, 0);
+        double seconds = timeParallel(threads, count, [&](size_t i, int id) {
+            for (int r = 0; r < 9; r++) {
+                size_t kept = kernels.filterDivisible(rowValues[r].data(), rowValues[r].size(), gcds[i],
+                                                      indexBuffers[id].data());
+                bytes[id] += 4.0 * (rowValues[r].size() + kept);
+                if (kept == 0) break;
+            }
+        });
+        double total = 0;
+        for (double b : bytes) total += b;
+        return make_pair(seconds, total);
+    };
+    for (int threads : threadCounts) {
+        pair<double, double> strong = filterStage(threads, BENCH_FILTER_GCDS);
+        add("filter", false, threads, strong.first, strong.second);
+    }
+    for (int threads : threadCounts) {
+        pair<double, double> weak = filterStage(threads, BENCH_FILTER_GCDS_PER_THREAD * threads);
+        add("filter", true, threads, weak.first, weak.second);
+    }
+    
+    // Backtracking: the instances of the first GCDs below 1100 that survive the filter.
+    vector<GcdInstance> instances;
+    array<vector<uint32_t>, 9> indices;
+    array<size_t, 9> counts;
+    for (int r = 0; r < 9; r++) {
+        indices[r].resize(rowValues[r].size());
+    }
+    for (uint32_t gcd = 1099; gcd > 1 && instances.size() < BENCH_INSTANCES; gcd--) {
+        bool empty = false;
+        for (int r = 0; r < 9 && !empty; r++) {
+            counts[r] = kernels.filterDivisible(rowValues[r].data(), rowValues[r].size(), gcd, indices[r].data());
+            empty = counts[r] == 0;
+        }
+        if (!empty) {
+            instances.push_back(buildInstance(int(gcd), rowValues, indices, counts));
+        }
+    }
+    vector<int> rowOrder = { 1, 8, 5, 3, 6, 7, 2, 0, 4 };
+    auto backtrackStage = [&](int threads, size_t count) {
+        vector<double> bytes(threads, 0);
+        double seconds = timeParallel(threads, count, [&](size_t i, int id) {
+            RowSolver solver(instances[i % instances.size()], kernels, rowOrder);
+            solver.nodeLimit = BENCH_NODE_LIMIT;
+            solver.run();
+            bytes[id] += double(solver.candidateTries) * sizeof(CandidateBits);
+        });
+        double total = 0;
+        for (double b : bytes) total += b;
+        return make_pair(seconds, total);
+    };
+    for (int threads : threadCounts) {
+        if (instances.empty()) break;
+        pair<double, double> strong = backtrackStage(threads, BENCH_SEARCHES);
+        add("backtrack", false, threads, strong.first, strong.second);
+    }
+    for (int threads : threadCounts) {
+        if (instances.empty()) break;
+        pair<double, double> weak = backtrackStage(threads, BENCH_SEARCHES_PER_THREAD * threads);
+        add("backtrack", true, threads, weak.first, weak.second);
+    }
+    return points;
+}
+
+} // namespace sudoku
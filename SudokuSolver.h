@@ -0,0 +1,489 @@
+#ifndef SUDOKU_SOLVER_H
+#define SUDOKU_SOLVER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------
+// Somewhat Square Sudoku solver library (C++ API)
+//
+// The stages of the solver - permutation generation, per-row clue filtering, per-GCD
+// divisibility filtering and the per-GCD search - behind one reusable Engine object.
+// Results are returned as packed row values (the 9-digit number of each row, top row
+// first) or copied into caller-provided buffers. See SudokuSolverC.h for the C ABI.
+//--------------------------------------------------------------------
+
+namespace sudoku {
+
+// Version of the solver's results; cached results from other versions are never reused.
+extern const char* const SOLVER_VERSION;
+
+// Per-column digit masks for one row: bit d set means digit d may appear in that column.
+using ColumnMasks = std::array<uint16_t, 9>;
+const uint16_t ALL_DIGITS_MASK = 0x3FF;
+
+constexpr void requireDigit(ColumnMasks& masks, int column, char value) {
+    masks[column] &= uint16_t(1 << (value - '0'));
+}
+
+constexpr void disallowDigits(ColumnMasks& masks, int column, std::initializer_list<char> values) {
+    for (char value : values) {
+        masks[column] &= uint16_t(~(1 << (value - '0')));
+    }
+}
+
+// Tightens the masks to what the clues imply, repeating until nothing changes: a cell left
+// with one digit removes it from its row, column and box (naked single). A required digit is
+// in every row, so in every column and box too; where a unit has one cell left for it, that
+// cell takes it (hidden single), and where a box's cells for it share a row or column, or a
+// line's share a box, it is cleared from the rest of that line or box (box-line reduction).
+// Returns the number of digits removed, or -1 if a cell or a required digit has no place left.
+constexpr int propagateClues(std::array<ColumnMasks, 9>& rowMasks, uint16_t requiredMask) {
+    // Cell i of unit u: rows 0-8, then columns 9-17, then boxes 18-26.
+    auto cellRow = [](int u, int i) { return u < 9 ? u : u < 18 ? i : 3 * ((u - 18) / 3) + i / 3; };
+    auto cellColumn = [](int u, int i) { return u < 9 ? i : u < 18 ? u - 9 : 3 * ((u - 18) % 3) + i % 3; };
+    auto bitCount = [](uint16_t mask) {
+        int count = 0;
+        for (; mask; mask &= uint16_t(mask - 1)) count++;
+        return count;
+    };
+    int removed = 0;
+    auto clear = [&](int r, int c, uint16_t digits) {
+        uint16_t kept = uint16_t(rowMasks[r][c] & ~digits);
+        removed += bitCount(rowMasks[r][c]) - bitCount(kept);
+        rowMasks[r][c] = kept;
+    };
+    
+    for (int before = -1; before != removed;) {
+        before = removed;
+        for (int r = 0; r < 9; r++) {
+            for (int c = 0; c < 9; c++) {
+                uint16_t mask = rowMasks[r][c];
+                if (mask == 0) return -1;
+                if (bitCount(mask) != 1) continue;
+                for (int i = 0; i < 9; i++) {
+                    int br = 3 * (r / 3) + i / 3;
+                    int bc = 3 * (c / 3) + i % 3;
+                    if (i != c) clear(r, i, mask);
+                    if (i != r) clear(i, c, mask);
+                    if (br != r || bc != c) clear(br, bc, mask);
+                }
+            }
+        }
+        for (int d = 0; d < 10; d++) {
+            uint16_t bit = uint16_t(1 << d);
+            if (!(requiredMask & bit)) continue;
+            for (int u = 0; u < 27; u++) {
+                int count = 0;
+                int last = 0;
+                uint16_t rows = 0;
+                uint16_t columns = 0;
+                uint16_t boxes = 0;
+                for (int i = 0; i < 9; i++) {
+                    int r = cellRow(u, i);
+                    int c = cellColumn(u, i);
+                    if (!(rowMasks[r][c] & bit)) continue;
+                    count++;
+                    last = i;
+                    rows |= uint16_t(1 << r);
+                    columns |= uint16_t(1 << c);
+                    boxes |= uint16_t(1 << (3 * (r / 3) + c / 3));
+                }
+                if (count == 0) return -1;
+                if (count == 1) {
+                    clear(cellRow(u, last), cellColumn(u, last), uint16_t(ALL_DIGITS_MASK & ~bit));
+                }
+                for (int j = 0; j < 9; j++) {
+                    if (u >= 18 && rows == (1 << j)) {
+                        // Box to row: the rest of row j.
+                        for (int c = 0; c < 9; c++) {
+                            if (c / 3 != (u - 18) % 3) clear(j, c, bit);
+                        }
+                    }
+                    if (u >= 18 && columns == (1 << j)) {
+                        for (int r = 0; r < 9; r++) {
+                            if (r / 3 != (u - 18) / 3) clear(r, j, bit);
+                        }
+                    }
+                    if (u < 18 && boxes == (1 << j)) {
+                        // Line to box: the box's cells off the line.
+                        for (int i = 0; i < 9; i++) {
+                            int r = 3 * (j / 3) + i / 3;
+                            int c = 3 * (j % 3) + i % 3;
+                            if ((u < 9 && r != u) || (u >= 9 && c != u - 9)) clear(r, c, bit);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return removed;
+}
+
+// The rules of one puzzle: digits every row must contain and the allowed digits of every cell.
+struct PuzzleDefinition {
+    std::vector<char> requiredDigits;
+    std::array<ColumnMasks, 9> rowMasks;
+};
+
+// The January 2025 clues, tightened by propagateClues, evaluated at compile time.
+constexpr std::array<ColumnMasks, 9> january2025Masks() {
+    std::array<ColumnMasks, 9> rowMasks = {};
+    for (ColumnMasks& masks : rowMasks) {
+        for (uint16_t& mask : masks) {
+            mask = ALL_DIGITS_MASK;
+        }
+    }
+    
+    // (Positions use 0-indexing.)
+    requireDigit(rowMasks[0], 7, '2');
+    requireDigit(rowMasks[1], 4, '2');
+    requireDigit(rowMasks[1], 8, '5');
+    requireDigit(rowMasks[2], 1, '2');
+    requireDigit(rowMasks[3], 2, '0');
+    requireDigit(rowMasks[5], 3, '2');
+    requireDigit(rowMasks[6], 4, '0');
+    requireDigit(rowMasks[7], 5, '2');
+    requireDigit(rowMasks[8], 6, '5');
+    propagateClues(rowMasks, (1 << 0) | (1 << 2) | (1 << 5));
+    return rowMasks;
+}
+
+constexpr std::array<ColumnMasks, 9> JANUARY_2025_MASKS = january2025Masks();
+
+// The January 2025 puzzle: rows contain 0, 2 and 5, cells are limited by JANUARY_2025_MASKS.
+PuzzleDefinition january2025Puzzle();
+
+// Row permutations (rows within bands, whole bands) that map the puzzle's clues onto themselves
+// and so map solutions to solutions; the identity is left out.
+std::vector<std::array<int, 9>> rowSymmetries(const PuzzleDefinition& puzzle);
+
+// Text form of a puzzle, one directive per line (rows and columns are 1-indexed, # starts a comment):
+//   digits 025           digits every row must contain
+//   require R C D        cell (R, C) is digit D
+//   disallow R C DIGITS  cell (R, C) is none of DIGITS
+//   allow R C DIGITS     cell (R, C) is one of DIGITS
+// Cells start with every digit allowed, and the masks are tightened with propagateClues once the
+// file is read. Returns false and sets error on a malformed file or clues that contradict each other.
+bool loadPuzzleDefinition(const std::string& path, PuzzleDefinition& puzzle, std::string& error);
+bool savePuzzleDefinition(const std::string& path, const PuzzleDefinition& puzzle);
+
+struct EngineConfig {
+    std::string kernels = "auto";           // auto, scalar, avx2 or avx512
+    std::string engine = "backtrack";       // backtrack, sat, clique or digits
+    std::string valueOrder = "lcv";         // lcv or generation
+    bool firstSolution = false;             // stop each GCD's search at its first solution
+    unsigned long long restartUnit = 0;     // candidate tries per Luby unit; 0 disables randomized restarts
+    int restartWorkers = 1;                 // parallel randomized searches per GCD
+    uint64_t seed = 1;                      // seed for randomized searches
+    bool portfolio = false;                 // race several solver configurations per GCD
+    std::string dimacsDir;                  // directory that each searched instance's CNF is written to
+    bool symmetryBreaking = true;           // search one grid per orbit of interchangeable rows
+    bool deterministic = false;             // parallel searches give timing-independent results and counters
+    bool numaReplicate = false;             // per-NUMA-node instance copies for parallel searches, workers pinned
+    bool traceWorkers = false;              // keep every worker task's span for Engine::writeTrace
+};
+
+// Counters shared with a progress reporter while a GCD is being searched.
+struct SearchProgress {
+    std::atomic<unsigned long long> candidateTries{0};
+};
+
+struct GenerationStats {
+    struct Digit {
+        char skipDigit;
+        bool skipped;                       // the digit is required, so it can't be the missing one
+        size_t validStrings;
+        size_t permutations;
+    };
+    std::vector<Digit> digits;
+    size_t total = 0;
+    long long milliseconds = 0;
+    bool reused = false;                    // same required digits as before; nothing was generated
+};
+
+// Scheduling counters of one worker of a parallel stage ("generation", "restarts" or
+// "portfolio"), summed over every time the stage ran.
+struct WorkerTelemetry {
+    std::string stage;
+    int worker = 0;
+    unsigned long long tasks = 0;           // permutation blocks, restart runs or portfolio races
+    double busySeconds = 0;                 // running tasks
+    double idleSeconds = 0;                 // waiting for work, a round barrier or the other workers
+    unsigned long long stealAttempts = 0;   // generation: other workers' queues looked at for work
+    unsigned long long steals = 0;          // and tasks taken from them
+    unsigned long long queueSamples = 0;    // generation: own queue depth, sampled at every take
+    unsigned long long queueDepthSum = 0;
+    size_t queueDepthMax = 0;
+};
+
+struct SolveResult {
+    std::vector<std::array<uint32_t, 9>> solutions;  // row values of each solution grid
+    bool exhausted = false;                 // the whole search space was covered
+    unsigned long long candidateTries = 0;
+    long long orderingMicros = 0;           // time spent ordering candidates
+    long long conversionNanos = 0;          // building the instance from the divisible candidates
+    long long solverNanos = 0;              // the search itself
+    std::string winner;                     // portfolio mode: winning configuration
+    double winnerSeconds = 0;
+    std::string summary;                    // engine-specific report line, may be empty
+};
+
+// Notified by Engine::search around every GCD that reaches the solving stage, and after
+// every GCD it examines.
+class SearchObserver {
+public:
+    virtual ~SearchObserver() = default;
+    virtual void solveStarted(uint32_t /*gcd*/, const SearchProgress& /*progress*/) {}
+    virtual void solveFinished(uint32_t /*gcd*/, const SolveResult& /*result*/) {}
+    virtual void gcdExamined(uint32_t /*gcd*/) {}
+};
+
+// Log-linear (HDR-style) histogram of non-negative samples: values below 2^subBits are
+// counted exactly and larger ones in 2^subBits buckets per power of two, so every reported
+// value is within a factor 1 + 2^-subBits of the recorded one. Recording is an index
+// computation and an increment.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(int subBits = 5);
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset();
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minimum : 0; }
+    uint64_t max() const { return maximum; }
+    double mean() const { return total ? sum / double(total) : 0; }
+    // Upper end of the bucket holding the sample at percentile p (0-100), capped at max().
+    uint64_t percentile(double p) const;
+
+private:
+    size_t bucket(uint64_t value) const;
+    uint64_t bucketHigh(size_t index) const;
+
+    int subBits;
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minimum = 0;
+    uint64_t maximum = 0;
+    double sum = 0;
+};
+
+// Per-GCD costs recorded by Engine::search. Every examined GCD is filtered; only those
+// whose rows all survive are converted and solved.
+struct StageHistograms {
+    LatencyHistogram filterNanos;
+    LatencyHistogram conversionNanos;
+    LatencyHistogram solverNanos;
+    LatencyHistogram nodes;                 // candidate tries of each solved GCD
+};
+
+// Running totals of Engine::search, for monitoring from another thread while it runs.
+struct SearchCounters {
+    uint32_t currentGCD = 0;                // GCD being examined, 0 between searches
+    unsigned long long gcdsExamined = 0;
+    std::array<unsigned long long, 9> emptyRow = {};  // GCDs the divisibility filter rejected, by first empty row
+    unsigned long long solved = 0;          // GCDs that reached the solver
+    unsigned long long infeasible = 0;      // of those, searched to the end without a solution
+    unsigned long long reused = 0;          // settled by a SweepState
+    unsigned long long nodes = 0;           // candidate tries, including the running search's so far
+};
+
+struct SearchOutcome {
+    bool found = false;
+    uint32_t gcd = 0;                       // the first GCD with a solution
+    SolveResult result;
+    bool reused = false;                    // the solution was taken from a SweepState
+    size_t reusedResults = 0;               // GCDs skipped because a SweepState already settled them
+};
+
+// What a sweep learned about each GCD it examined, kept across runs so that a sweep over an
+// edited puzzle only re-examines the GCDs whose result the edit could have changed.
+class SweepState {
+public:
+    enum Status : uint8_t {
+        UNKNOWN = 0,
+        EMPTY_ROW = 1,                      // EMPTY_ROW + r: row r had no candidate divisible by the GCD
+        INFEASIBLE = 10,                    // searched exhaustively without a solution
+        FEASIBLE = 11,                      // every solution is recorded
+        WITNESSED = 12                      // some solutions are recorded
+    };
+    
+    PuzzleDefinition puzzle;                // the definition every recorded status refers to
+    
+    Status status(uint32_t gcd) const;
+    const std::vector<std::array<uint32_t, 9>>* solutions(uint32_t gcd) const;
+    void record(uint32_t gcd, Status status, const std::vector<std::array<uint32_t, 9>>& solutions = {});
+    size_t recordedCount() const;
+    
+    // Re-targets the state at an edited puzzle, dropping every status the edit could have changed.
+    // Returns the number of statuses dropped.
+    size_t rebase(const PuzzleDefinition& edited);
+    
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    
+private:
+    uint32_t low = 0;                       // gcd of statuses[0]
+    std::vector<uint8_t> statuses;
+    std::map<uint32_t, std::vector<std::array<uint32_t, 9>>> solutionsByGcd;
+};
+
+// Canonical hash of a puzzle's rules and clues (as digit sets and masks, so equivalent
+// definition files agree) and the solver version.
+uint64_t puzzleHash(const PuzzleDefinition& puzzle);
+
+// What is known about a puzzle's sweep from searchedFrom downwards.
+struct CachedResult {
+    uint32_t searchedFrom = 0;              // highest GCD of the sweep
+    uint32_t frontier = 0;                  // every GCD from searchedFrom down to frontier has been examined
+    uint32_t bestGCD = 0;                   // highest GCD with a solution; 0 if none has been found
+    bool complete = false;                  // solutions holds every solution for bestGCD
+    std::vector<std::array<uint32_t, 9>> solutions;
+};
+
+// On-disk store of sweep results, one file per puzzle hash in a shared directory.
+class ResultCache {
+public:
+    explicit ResultCache(const std::string& directory) : directory(directory) {}
+    std::string path(const PuzzleDefinition& puzzle) const;
+    bool lookup(const PuzzleDefinition& puzzle, CachedResult& result) const;
+    bool store(const PuzzleDefinition& puzzle, const CachedResult& result) const;
+    
+private:
+    std::string directory;
+};
+
+// Differential self-check: fuzzes the SIMD kernels and every solver configuration against the
+// original string-based filters and recursive search on random numbers and small random puzzles.
+struct SelfCheckReport {
+    size_t cases = 0;                       // comparisons made
+    std::vector<std::string> failures;      // one line per mismatch (at most 100)
+};
+SelfCheckReport runSelfCheck(uint64_t seed, size_t iterations);
+
+// Thread-scaling benchmark of the generation, divisibility-filter and backtracking stages on
+// fixed inputs. Strong scaling keeps the work fixed; weak scaling gives each thread a fixed
+// share (the filter and backtracking stages only, as generation's work is set by the puzzle).
+// Speedup and efficiency are relative to the first thread count, which should be 1.
+struct ScalingPoint {
+    std::string stage;                      // generation, filter or backtrack
+    bool weak = false;
+    int threads = 1;
+    double seconds = 0;
+    double speedup = 1;                     // weak scaling: scaled speedup, threads * T(1) / T(n)
+    double efficiency = 1;                  // speedup / threads
+    double gigabytesPerSecond = 0;          // estimated from the bytes the stage's arrays move
+};
+std::vector<ScalingPoint> runScalingBenchmark(const std::vector<int>& threadCounts, const PuzzleDefinition& puzzle);
+
+// A generated puzzle of the same rule family with a planted solution: every row of the
+// planted grid is divisible by the requested GCD, so the puzzle's answer is at least that.
+struct SyntheticPuzzle {
+    PuzzleDefinition puzzle;
+    std::array<uint32_t, 9> planted = {};   // row values of the planted solution
+    uint32_t plantedGCD = 0;                // gcd of the planted rows, a multiple of the requested GCD
+    size_t givens = 0;                      // cells fixed to their planted digit
+    size_t disallowedCells = 0;             // cells with one to three other digits ruled out
+};
+// Plants a grid whose rows are all multiples of gcd and turns some of its cells into clues.
+// The grid comes from randomized first-solution runs over the clue-free rows that leave out
+// one random digit. If that finds no grid within a fixed search budget, the other digits are
+// tried in turn. givenDensity is the share of the 81 cells fixed to their planted digit.
+// disallowDensity is the share of the 81 cells, taken from those not given, that rule out
+// one to three other digits. The given digits become the puzzle's required digits, and the
+// same seed gives the same puzzle. Returns false, leaving out untouched, if no left-out digit
+// yields a grid.
+bool generateSyntheticPuzzle(uint32_t gcd, double givenDensity, double disallowDensity, uint64_t seed,
+                             SyntheticPuzzle& out);
+
+// Process-wide sampling profiler: SIGPROF fires every intervalMicros of CPU time and the
+// sample is charged to the interrupted thread's phase (generation, row-filter, divisibility,
+// conversion, ordering, search, sat, other) and, in the backtracking search, to the number
+// of rows placed. Returns false where setitimer is unavailable or if already running.
+bool startProfiler(unsigned intervalMicros);
+void stopProfiler();
+// Writes the samples as folded stacks, one line per phase and depth ("sudoku;search;depth0;
+// depth1 42": 42 samples while placing the second row), for flamegraph.pl and similar tools.
+bool writeProfile(const std::string& path);
+
+class Engine {
+public:
+    explicit Engine(const EngineConfig& config = EngineConfig());
+    ~Engine();
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    const EngineConfig& config() const;
+    // Name of the kernel set in use and a one-line report of how it was chosen.
+    const std::string& kernelSet() const;
+    const std::string& kernelReport() const;
+
+    // Stage 1: every 9-digit string with one digit missing that contains all requiredDigits.
+    // Repeating the previous call's requiredDigits keeps the generated numbers.
+    GenerationStats generate(const std::vector<char>& requiredDigits, unsigned threads);
+    size_t numberCount() const;
+
+    // Stage 2: each row's base candidates, the generated numbers allowed by its column masks
+    // after propagateClues with the required digits of generate. Only rows whose masks differ
+    // from the previous call are recomputed; returns a bit per recomputed row.
+    unsigned filterRows(const std::array<ColumnMasks, 9>& rowMasks);
+    size_t rowSize(int row) const;
+    // Copies up to capacity row values and returns the full count.
+    size_t copyRowValues(int row, uint32_t* out, size_t capacity) const;
+    // Divisors among 3, 9, 11, 33 and 99 that no grid of the current rows can have in every
+    // row, whichever digit its rows leave out (solve searches one such digit at a time), so
+    // no candidate GCD divisible by them needs testing. Omits multiples of earlier ones.
+    std::vector<uint32_t> invariantExclusions() const;
+    
+    // Writes the current rows as the SudokuTables.inc source that a build with
+    // SUDOKU_EMBEDDED_TABLES compiles in.
+    bool writeRowTables(const std::string& path) const;
+    // Stages 1 and 2 from the compiled-in rows, if puzzle is the one they were written for.
+    // Returns false otherwise, and always without SUDOKU_EMBEDDED_TABLES. Editing the rows
+    // afterwards needs a generate call first.
+    bool loadEmbeddedRows(const PuzzleDefinition& puzzle);
+
+    // Stage 3: keep each row's candidates divisible by gcd. Returns false if a row is left empty.
+    bool filterDivisible(uint32_t gcd);
+    size_t divisibleCount(int row) const;
+    size_t copyDivisibleValues(int row, uint32_t* out, size_t capacity) const;
+
+    // Stage 4: search the instance left by the last successful filterDivisible. All rows of a
+    // grid leave out the same digit, so the engine runs once per such digit on the candidates
+    // leaving it out, skipping digits that leave a row empty. The digits engine searches all
+    // of the rows of stage 2 instead, and search() skips stage 3 for it.
+    SolveResult solve(SearchProgress* progress = nullptr);
+
+    // Per-worker scheduling counters of the parallel stages so far. Safe to call while a
+    // search is running, e.g. for a status line.
+    std::vector<WorkerTelemetry> workerTelemetry() const;
+    // Writes the worker task spans kept with traceWorkers as Chrome trace-event JSON.
+    bool writeTrace(const std::string& path) const;
+
+    // Totals of every search so far; safe to call while a search is running.
+    SearchCounters searchCounters() const;
+
+    // Per-GCD stage costs of every search so far.
+    const StageHistograms& stageHistograms() const;
+
+    // Stages 3 and 4 for each GCD in turn, stopping at the first one with a solution. With a
+    // state, GCDs it has already settled are skipped and every GCD examined is recorded in it;
+    // the state is first rebased onto the engine's current puzzle.
+    SearchOutcome search(const std::vector<uint32_t>& gcds, SearchObserver* observer = nullptr,
+                         SweepState* state = nullptr);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace sudoku
+
+#endif // SUDOKU_SOLVER_H
@@ -0,0 +1,176 @@
+#include "SudokuSolverC.h"
+#include "SudokuSolver.h"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+using namespace std;
+using namespace sudoku;
+
+//--------------------------------------------------------------------
+// C ABI over sudoku::Engine. Exceptions never cross the boundary.
+//--------------------------------------------------------------------
+
+struct sqs_engine {
+    Engine engine;
+    bool generated = false;
+    bool filtered = false;
+    bool instance = false;
+    explicit sqs_engine(const EngineConfig& config) : engine(config) {}
+};
+
+namespace {
+
+int copySolutions(const SolveResult& result, uint32_t* grids, size_t maxSolutions,
+                  size_t* solutionCount, sqs_stats* stats) {
+    if (solutionCount) *solutionCount = result.solutions.size();
+    if (stats) {
+        stats->candidate_tries = result.candidateTries;
+        stats->ordering_micros = result.orderingMicros;
+        stats->exhausted = result.exhausted ? 1 : 0;
+    }
+    size_t copied = grids ? min(maxSolutions, result.solutions.size()) : 0;
+    for (size_t i = 0; i < copied; i++) {
+        copy(result.solutions[i].begin(), result.solutions[i].end(), grids + i * 9);
+    }
+    return copied < result.solutions.size() && maxSolutions > 0 ? SQS_ERROR_CAPACITY : SQS_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+void sqs_config_init(sqs_config* config) {
+    if (!config) return;
+    config->kernels = "auto";
+    config->engine = "backtrack";
+    config->value_order = "lcv";
+    config->first_solution = 0;
+    config->restart_unit = 0;
+    config->restart_workers = 1;
+    config->seed = 1;
+    config->portfolio = 0;
+    config->dimacs_dir = nullptr;
+}
+
+sqs_engine* sqs_engine_create(const sqs_config* config) {
+    sqs_config defaults;
+    sqs_config_init(&defaults);
+    if (!config) config = &defaults;
+    EngineConfig engineConfig;
+    if (config->kernels) engineConfig.kernels = config->kernels;
+    if (config->engine) engineConfig.engine = config->engine;
+    if (config->value_order) engineConfig.valueOrder = config->value_order;
+    engineConfig.firstSolution = config->first_solution != 0;
+    engineConfig.restartUnit = config->restart_unit;
+    engineConfig.restartWorkers = max(1, config->restart_workers);
+    engineConfig.seed = config->seed;
+    engineConfig.portfolio = config->portfolio != 0;
+    if (config->dimacs_dir) engineConfig.dimacsDir = config->dimacs_dir;
+    try {
+        return new sqs_engine(engineConfig);
+    } catch (const exception&) {
+        return nullptr;
+    }
+}
+
+void sqs_engine_destroy(sqs_engine* engine) {
+    delete engine;
+}
+
+const char* sqs_kernel_set(const sqs_engine* engine) {
+    return engine ? engine->engine.kernelSet().c_str() : "";
+}
+
+void sqs_january2025_masks(uint16_t masks[81]) {
+    PuzzleDefinition puzzle = january2025Puzzle();
+    for (int r = 0; r < 9; r++) {
+        copy(puzzle.rowMasks[r].begin(), puzzle.rowMasks[r].end(), masks + r * 9);
+    }
+}
+
+const char* sqs_january2025_required_digits(void) {
+    return "025";
+}
+
+int sqs_generate(sqs_engine* engine, const char* required_digits, unsigned threads, size_t* count) {
+    if (!engine || !required_digits) return SQS_ERROR_ARGUMENT;
+    try {
+        vector<char> required(required_digits, required_digits + string(required_digits).size());
+        engine->engine.generate(required, threads);
+    } catch (const exception&) {
+        return SQS_ERROR_STATE;
+    }
+    engine->generated = true;
+    engine->filtered = engine->instance = false;
+    if (count) *count = engine->engine.numberCount();
+    return SQS_OK;
+}
+
+int sqs_filter_rows(sqs_engine* engine, const uint16_t masks[81], size_t counts[9]) {
+    if (!engine || !masks) return SQS_ERROR_ARGUMENT;
+    if (!engine->generated) return SQS_ERROR_STATE;
+    array<ColumnMasks, 9> rowMasks;
+    for (int r = 0; r < 9; r++) {
+        copy(masks + r * 9, masks + r * 9 + 9, rowMasks[r].begin());
+    }
+    try {
+        engine->engine.filterRows(rowMasks);
+    } catch (const exception&) {
+        return SQS_ERROR_STATE;
+    }
+    engine->filtered = true;
+    engine->instance = false;
+    if (counts) {
+        for (int r = 0; r < 9; r++) counts[r] = engine->engine.rowSize(r);
+    }
+    return SQS_OK;
+}
+
+int sqs_copy_row_values(const sqs_engine* engine, int row, uint32_t* out, size_t capacity, size_t* count) {
+    if (!engine || row < 0 || row >= 9 || (!out && capacity > 0)) return SQS_ERROR_ARGUMENT;
+    if (!engine->filtered) return SQS_ERROR_STATE;
+    size_t total = engine->engine.copyRowValues(row, out, capacity);
+    if (count) *count = total;
+    return total > capacity ? SQS_ERROR_CAPACITY : SQS_OK;
+}
+
+int sqs_filter_divisible(sqs_engine* engine, uint32_t gcd, size_t counts[9]) {
+    if (!engine || gcd == 0) return SQS_ERROR_ARGUMENT;
+    if (!engine->filtered) return SQS_ERROR_STATE;
+    engine->instance = engine->engine.filterDivisible(gcd);
+    if (counts) {
+        for (int r = 0; r < 9; r++) counts[r] = engine->engine.divisibleCount(r);
+    }
+    return engine->instance ? SQS_OK : SQS_NO_CANDIDATES;
+}
+
+int sqs_solve(sqs_engine* engine, uint32_t* grids, size_t max_solutions, size_t* solution_count, sqs_stats* stats) {
+    if (!engine) return SQS_ERROR_ARGUMENT;
+    if (!engine->instance) return SQS_ERROR_STATE;
+    try {
+        return copySolutions(engine->engine.solve(), grids, max_solutions, solution_count, stats);
+    } catch (const exception&) {
+        return SQS_ERROR_STATE;
+    }
+}
+
+int sqs_search(sqs_engine* engine, const uint32_t* gcds, size_t gcd_count, uint32_t* found_gcd,
+               uint32_t* grids, size_t max_solutions, size_t* solution_count, sqs_stats* stats) {
+    if (!engine || (!gcds && gcd_count > 0)) return SQS_ERROR_ARGUMENT;
+    if (!engine->filtered) return SQS_ERROR_STATE;
+    try {
+        for (size_t i = 0; i < gcd_count; i++) {
+            if (gcds[i] == 0) return SQS_ERROR_ARGUMENT;
+        }
+        SearchOutcome outcome = engine->engine.search(vector<uint32_t>(gcds, gcds + gcd_count));
+        engine->instance = outcome.found;
+        if (found_gcd) *found_gcd = outcome.found ? outcome.gcd : 0;
+        return copySolutions(outcome.result, grids, max_solutions, solution_count, stats);
+    } catch (const exception&) {
+        return SQS_ERROR_STATE;
+    }
+}
+
+} // extern "C"
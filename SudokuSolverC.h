@@ -0,0 +1,72 @@
+#ifndef SUDOKU_SOLVER_C_H
+#define SUDOKU_SOLVER_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*--------------------------------------------------------------------
+ * Somewhat Square Sudoku solver library (C ABI)
+ *
+ * A thin wrapper over sudoku::Engine for callers that can't use the C++ API. All
+ * buffers are owned by the caller: row masks are 81 uint16_t (row-major, bit d set
+ * when digit d is allowed), solution grids are 9 uint32_t row values each.
+ *--------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sqs_engine sqs_engine;
+
+enum {
+    SQS_OK = 0,
+    SQS_NO_CANDIDATES = 1,      /* a row has no candidate divisible by the GCD */
+    SQS_ERROR_ARGUMENT = -1,
+    SQS_ERROR_STATE = -2,       /* called before the stage it depends on */
+    SQS_ERROR_CAPACITY = -3     /* output buffer too small; the required size is still reported */
+};
+
+typedef struct sqs_config {
+    const char* kernels;        /* "auto", "scalar", "avx2" or "avx512" */
+    const char* engine;         /* "backtrack" or "sat" */
+    const char* value_order;    /* "lcv" or "generation" */
+    int first_solution;
+    unsigned long long restart_unit;
+    int restart_workers;
+    uint64_t seed;
+    int portfolio;
+    const char* dimacs_dir;     /* NULL or empty to disable */
+} sqs_config;
+
+typedef struct sqs_stats {
+    unsigned long long candidate_tries;
+    long long ordering_micros;
+    int exhausted;
+} sqs_stats;
+
+void sqs_config_init(sqs_config* config);
+
+sqs_engine* sqs_engine_create(const sqs_config* config);
+void sqs_engine_destroy(sqs_engine* engine);
+const char* sqs_kernel_set(const sqs_engine* engine);
+
+/* The January 2025 puzzle: its row masks (81 entries) and required digits as a NUL-terminated string. */
+void sqs_january2025_masks(uint16_t masks[81]);
+const char* sqs_january2025_required_digits(void);
+
+int sqs_generate(sqs_engine* engine, const char* required_digits, unsigned threads, size_t* count);
+int sqs_filter_rows(sqs_engine* engine, const uint16_t masks[81], size_t counts[9]);
+int sqs_copy_row_values(const sqs_engine* engine, int row, uint32_t* out, size_t capacity, size_t* count);
+
+int sqs_filter_divisible(sqs_engine* engine, uint32_t gcd, size_t counts[9]);
+/* Solves the last filtered instance; grids receives up to max_solutions grids of 9 row values. */
+int sqs_solve(sqs_engine* engine, uint32_t* grids, size_t max_solutions, size_t* solution_count, sqs_stats* stats);
+/* Filters and solves each GCD in turn; found_gcd is 0 when none of them has a solution. */
+int sqs_search(sqs_engine* engine, const uint32_t* gcds, size_t gcd_count, uint32_t* found_gcd,
+               uint32_t* grids, size_t max_solutions, size_t* solution_count, sqs_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SUDOKU_SOLVER_C_H */